@@ -0,0 +1,214 @@
+#!/usr/bin/env python3
+"""
+kmp.py
+
+Binary plateau files (.kmp) and k(n) queries over them.
+
+Layout (little endian, packed), as written by `mk --bin=FILE`:
+  header   magic "KMP1", flags, count, index_shift, reserved, index_off  (32 bytes)
+  records  count x (u32 k, u64 m), sorted by m
+  index    ceil(count / 2^index_shift) u64: the m of every 2^index_shift-th record
+
+flags bit 0 (DENSE) marks a sampled step function (n, k(n)) stored as (k=k(n), m=n)
+instead of plateau points. Either way k(n) = k of the last record with m <= n, so a
+query is a bisection over the index and then over one block of records; the file is
+memory-mapped, and only the pages a query touches are read.
+
+Usage:
+  python kmp.py km_plateaus.csv km_plateaus.kmp      # convert (CSV -> binary)
+  python kmp.py km_plateaus.kmp --k-of-n 1e6 1e12    # query
+  python kmp.py km_plateaus.kmp --dump               # back to "k,m" text
+"""
+
+import argparse
+import mmap
+import struct
+from bisect import bisect_right
+
+MAGIC = 0x31504D4B  # "KMP1"
+HEADER = struct.Struct("<IIQIIQ")
+RECORD = struct.Struct("<IQ")
+FLAG_DENSE = 1
+INDEX_SHIFT = 10
+
+
+class KmpFile:
+    """A memory-mapped .kmp file."""
+
+    def __init__(self, path):
+        self._f = open(path, "rb")
+        self._mm = mmap.mmap(self._f.fileno(), 0, access=mmap.ACCESS_READ)
+        magic, self.flags, self.count, self.shift, _, index_off = HEADER.unpack_from(self._mm, 0)
+        blocks = (self.count + (1 << self.shift) - 1) >> self.shift
+        if magic != MAGIC or len(self._mm) < index_off + 8 * blocks \
+                or index_off < HEADER.size + RECORD.size * self.count:
+            self.close()
+            raise ValueError(f"{path}: not a KMP1 file")
+        self._index = struct.unpack_from(f"<{blocks}Q", self._mm, index_off)
+
+    def close(self):
+        self._mm.close()
+        self._f.close()
+
+    def __enter__(self):
+        return self
+
+    def __exit__(self, *exc):
+        self.close()
+
+    def __len__(self):
+        return self.count
+
+    def record(self, i):
+        """(k, m) of record i."""
+        return RECORD.unpack_from(self._mm, HEADER.size + RECORD.size * i)
+
+    def _m(self, i):
+        return struct.unpack_from("<Q", self._mm, HEADER.size + RECORD.size * i + 4)[0]
+
+    def arrays(self):
+        """(k, m) as NumPy int64 / float64 arrays, in file order (copies; the file may close)."""
+        import numpy as np
+
+        rec = np.frombuffer(self._mm, dtype=np.dtype([("k", "<u4"), ("m", "<u8")]),
+                            count=self.count, offset=HEADER.size)
+        k, m = rec["k"].astype(np.int64), rec["m"].astype(np.float64)
+        del rec
+        return k, m
+
+    def points(self):
+        """Every (k, m) record, in file order."""
+        end = HEADER.size + RECORD.size * self.count
+        return list(RECORD.iter_unpack(memoryview(self._mm)[HEADER.size:end]))
+
+    def k_of_n(self, n):
+        """max { k : m(k) <= n }, 0 when no record has m <= n."""
+        b = bisect_right(self._index, n) - 1
+        if b < 0:
+            return 0
+        lo = b << self.shift  # m(lo) <= n
+        hi = min(lo + (1 << self.shift), self.count)
+        while hi - lo > 1:
+            mid = (lo + hi) // 2
+            if self._m(mid) <= n:
+                lo = mid
+            else:
+                hi = mid
+        return self.record(lo)[0]
+
+
+class PointIndex:
+    """The same queries over an in-memory list of (k, m) points (e.g. from a CSV)."""
+
+    def __init__(self, points):
+        self._pts = sorted(points, key=lambda km: (km[1], km[0]))
+        self._ms = [m for (_, m) in self._pts]
+        self.flags = 0
+
+    def close(self):
+        pass
+
+    def __enter__(self):
+        return self
+
+    def __exit__(self, *exc):
+        pass
+
+    def __len__(self):
+        return len(self._pts)
+
+    def record(self, i):
+        return self._pts[i]
+
+    def points(self):
+        return list(self._pts)
+
+    def k_of_n(self, n):
+        i = bisect_right(self._ms, n) - 1
+        return self._pts[i][0] if i >= 0 else 0
+
+
+def read_csv_points(path):
+    """(k, m) from "k,m" / "k, m" lines; headers, blank and "; ..." lines are skipped."""
+    pts = []
+    with open(path) as f:
+        for line in f:
+            parts = line.split(",")
+            if len(parts) < 2 or not parts[0].strip().isdigit():
+                continue
+            pts.append((int(parts[0]), int(parts[1])))
+    return pts
+
+
+def is_kmp(path):
+    with open(path, "rb") as f:
+        head = f.read(4)
+    return len(head) == 4 and struct.unpack("<I", head)[0] == MAGIC
+
+
+def open_points(path):
+    """KmpFile for a .kmp file, else a PointIndex over the CSV."""
+    if is_kmp(path):
+        return KmpFile(path)
+    return PointIndex(read_csv_points(path))
+
+
+def load_points(path):
+    """Sorted (k, m) list from either format."""
+    with open_points(path) as src:
+        return sorted(src.points())
+
+
+def write_kmp(path, points, dense=False):
+    """Write (k, m) points sorted by m; k(n) needs k non-decreasing along m."""
+    pts = sorted(points, key=lambda km: (km[1], km[0]))
+    for (k0, _), (k1, _) in zip(pts, pts[1:]):
+        if k1 < k0:
+            raise ValueError("k decreases along m: not a step function k(n)")
+
+    count = len(pts)
+    blocks = (count + (1 << INDEX_SHIFT) - 1) >> INDEX_SHIFT
+    index_off = (HEADER.size + RECORD.size * count + 7) & ~7
+    buf = bytearray(index_off + 8 * blocks)
+    HEADER.pack_into(buf, 0, MAGIC, FLAG_DENSE if dense else 0, count, INDEX_SHIFT, 0, index_off)
+    for i, (k, m) in enumerate(pts):
+        RECORD.pack_into(buf, HEADER.size + RECORD.size * i, k, m)
+        if i % (1 << INDEX_SHIFT) == 0:
+            struct.pack_into("<Q", buf, index_off + 8 * (i >> INDEX_SHIFT), m)
+    with open(path, "wb") as f:
+        f.write(buf)
+
+
+def parse_n(s):
+    """An exact int, or a 1e6-style float for inputs that are not one (rounded above 2^53)."""
+    try:
+        return int(s)
+    except ValueError:
+        return int(float(s))
+
+
+def main():
+    ap = argparse.ArgumentParser()
+    ap.add_argument("src", help="CSV or .kmp input")
+    ap.add_argument("dst", nargs="?", help="Write src as a .kmp file")
+    ap.add_argument("--dense", action="store_true", help="Mark the output as sampled (n, k(n)) points")
+    ap.add_argument("--k-of-n", type=parse_n, nargs="+", metavar="N", help="Print k(n) for each N")
+    ap.add_argument("--dump", action="store_true", help="Print the records as k,m lines")
+    args = ap.parse_args()
+
+    if args.dst:
+        pts = load_points(args.src)
+        write_kmp(args.dst, pts, dense=args.dense)
+        print(f"Wrote: {args.dst} ({len(pts)} records)")
+
+    with open_points(args.src) as src:
+        if args.dump:
+            print("k,m")
+            for k, m in src.points():
+                print(f"{k},{m}")
+        for n in args.k_of_n or []:
+            print(f"k({n}) = {src.k_of_n(n)}")
+
+
+if __name__ == "__main__":
+    main()
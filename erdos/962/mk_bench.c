@@ -0,0 +1,330 @@
+// mk_bench.c
+//
+// Microbenchmarks for mk_iocp_tiled_sieve_strided_fastdiv.c (included whole, without its
+// main), one thread, CSV on stdout so runs of two kernel variants can be diffed:
+// - fastdiv: fastdiv_u32_divmod as built against hardware div, plus the single-correction
+//   form; check counts results that differ from div (0 means FASTDIV_2X_CORRECT=0 is safe
+//   for these operands). The *_test rows time the divisibility test alone, FastDiv
+//   against ExactDivU64; check counts verdicts that differ from x % d == 0
+// - sieve:   ns per integer of one kernel's bad-bits window (exact, lean, log) across k and
+//   tile_len, sieving BENCH_SIEVE_TILES consecutive tiles from m(k) with carried offsets
+//   (offset setup not timed); check is the count of smooth values, which must agree
+//   between kernels
+// - scan:    scan_tile_find_m_carried_fastdiv end to end over BENCH_SCAN_TILES tiles before
+//   each seed m(k) from km_plateaus.csv, with the run carried as in --contig lanes; check
+//   is the m found and must equal m0
+//
+// Build (Linux / POSIX):
+//   cc -O3 -std=c11 -march=native mk_bench.c -o mk_bench -lpthread -lm
+//
+// Build (clang, in VS dev prompt):
+//   clang -O3 -std=c11 -march=native mk_bench.c -o mk_bench.exe -lkernel32 -ladvapi32 -lws2_32 -fuse-ld=lld
+//
+// Usage:
+//   mk_bench [--csv=km_plateaus.csv] [--k=20,100,500,2000] [--tile=16384,65536,262144]
+//            [--ms=300] [--only=fastdiv|sieve|scan] [--simd=auto|scalar|avx2|avx512]
+//
+//   --ms      time budget per row: passes are repeated until it is used up
+//
+// Columns: bench, variant, simd, param (divisor or k), tile_len, m0, ops, ns_per_op, check
+
+#define MK_NO_MAIN
+#if defined(__clang__) || defined(__GNUC__)
+#pragma GCC diagnostic ignored "-Wunused-function"   // the search driver is not called here
+#endif
+#include "mk_iocp_tiled_sieve_strided_fastdiv.c"
+
+#ifndef BENCH_SIEVE_TILES
+#define BENCH_SIEVE_TILES 16u
+#endif
+#ifndef BENCH_SCAN_TILES
+#define BENCH_SCAN_TILES 8u
+#endif
+#define BENCH_FD_COUNT  (1u << 16)
+#define BENCH_MAX_LIST  32
+
+static const char* const bench_kernel_name[] = { "exact", "log", "lean" };
+
+typedef struct BenchCfg {
+	uint32_t  k[BENCH_MAX_LIST];
+	uint32_t  k_count;
+	uint32_t  tile[BENCH_MAX_LIST];
+	uint32_t  tile_count;
+	uint32_t  ms;
+	uint64_t* seed_k;       // plateau points, increasing k
+	uint64_t* seed_m;
+	uint32_t  seed_count;
+} BenchCfg;
+
+static uint32_t bench_list(const char* s, uint32_t* out) {
+	uint32_t n = 0;
+	while (*s && n < BENCH_MAX_LIST) {
+		char* end;
+		uint32_t v = (uint32_t)strtoul(s, &end, 10);
+		if (end == s) break;
+		if (v) out[n++] = v;
+		s = (*end == ',') ? end + 1 : end;
+	}
+	return n;
+}
+
+static void bench_read_seeds(BenchCfg* c, const char* path) {
+	FILE* f = fopen(path, "r");
+	if (!f) {
+		fprintf(stderr, "cannot open %s\n", path);
+		exit(1);
+	}
+
+	uint32_t cap = 0;
+	char line[128];
+	while (fgets(line, sizeof(line), f)) {
+		unsigned long long k, m;
+		if (sscanf(line, "%llu,%llu", &k, &m) != 2) continue;   // header
+		if (c->seed_count == cap) {
+			cap = cap ? 2 * cap : 256;
+			c->seed_k = (uint64_t*)realloc(c->seed_k, cap * sizeof(uint64_t));
+			c->seed_m = (uint64_t*)realloc(c->seed_m, cap * sizeof(uint64_t));
+			if (!c->seed_k || !c->seed_m) {
+				fprintf(stderr, "realloc failed for seeds (count=%u)\n", cap);
+				exit(2);
+			}
+		}
+		c->seed_k[c->seed_count] = k;
+		c->seed_m[c->seed_count] = m;
+		++c->seed_count;
+	}
+	fclose(f);
+}
+
+// m(k) from the plateau points; UINT64_MAX past the last one (the next jump is unknown).
+static uint64_t bench_m_of_k(const BenchCfg* c, uint32_t k) {
+	uint64_t m = UINT64_MAX;
+	for (uint32_t i = 0; i < c->seed_count && c->seed_k[i] <= k; ++i) m = c->seed_m[i];
+	if (c->seed_count && k > c->seed_k[c->seed_count - 1]) m = UINT64_MAX;
+	return m;
+}
+
+static uint32_t bench_count_bits(const uint8_t* bits, uint32_t n) {
+	uint32_t c = 0;
+	for (uint32_t i = 0; i < n / 8; ++i) c += (uint32_t)__builtin_popcount(bits[i]);
+	if (n & 7) c += (uint32_t)__builtin_popcount(bits[n / 8] & ((1u << (n & 7)) - 1u));
+	return c;
+}
+
+static void bench_row(const char* bench, const char* variant, uint64_t param, uint32_t tile_len, uint64_t m0, uint64_t ops, uint64_t us, uint64_t check) {
+	printf("%s,%s,%s,%llu,%u,%llu,%llu,%.3f,%llu\n", bench, variant, g_simd.name, (unsigned long long)param, tile_len,
+		(unsigned long long)m0, (unsigned long long)ops, ops ? 1000.0 * (double)us / (double)ops : 0.0, (unsigned long long)check);
+}
+
+// ------------------------------------------------------------
+// fastdiv: u64 / u32 over random operands
+// ------------------------------------------------------------
+
+static uint64_t bench_xorshift(uint64_t* s) {
+	uint64_t x = *s;
+	x ^= x << 13; x ^= x >> 7; x ^= x << 17;
+	return *s = x;
+}
+
+// fastdiv_u32_divmod with the first correction only (FASTDIV_2X_CORRECT=0).
+static FORCEINLINE void bench_divmod_1x(const FastDivU32* fd, uint64_t n, uint64_t* q, uint32_t* r) {
+	uint64_t d = fd->d;
+	uint64_t q0 = mulhi_u64(n, fd->mul);
+	uint64_t rr = n - q0 * d;
+	if (rr >= d) { rr -= d; ++q0; }
+	*q = q0;
+	*r = (uint32_t)rr;
+}
+
+static void bench_fastdiv(const BenchCfg* c) {
+	static const uint32_t divisors[] = { 3, 17, 251, 4093, 65521, 1048573, 4294967291u };
+	uint64_t* x = (uint64_t*)malloc(BENCH_FD_COUNT * sizeof(uint64_t));
+	if (!x) { fprintf(stderr, "malloc failed for operands\n"); exit(2); }
+	uint64_t s = 0x9E3779B97F4A7C15ull;
+	for (uint32_t i = 0; i < BENCH_FD_COUNT; ++i) x[i] = bench_xorshift(&s);
+
+	for (uint32_t di = 0; di < sizeof(divisors) / sizeof(divisors[0]); ++di) {
+		volatile uint32_t dv = divisors[di];   // keep the hardware div a real div
+		uint64_t d = dv;
+		FastDivU32 fd = fastdiv_u32_make_prime(dv);
+		ExactDivU64 xd = exactdiv_make(dv);
+
+		for (uint32_t variant = 0; variant < 5; ++variant) {
+			uint64_t ops = 0, acc = 0, t0 = sys_now_us(), us;
+			do {
+				for (uint32_t i = 0; variant < 3 && i < BENCH_FD_COUNT; ++i) {
+					uint64_t q; uint32_t r;
+					if      (variant == 0) fastdiv_u32_divmod(&fd, x[i], &q, &r);
+					else if (variant == 1) bench_divmod_1x(&fd, x[i], &q, &r);
+					else { q = x[i] / d; r = (uint32_t)(x[i] % d); }
+					acc += q ^ r;
+				}
+				for (uint32_t i = 0; variant >= 3 && i < BENCH_FD_COUNT; ++i) {
+					uint64_t y = x[i];
+					acc += (variant == 3) ? (uint64_t)fastdiv_u32_divide_if_divisible(&fd, &y) : (uint64_t)exactdiv_divide_if_divisible(&xd, &y);
+					acc += y;
+				}
+				ops += BENCH_FD_COUNT;
+				us = sys_now_us() - t0;
+			} while (us < (uint64_t)c->ms * 1000u);
+
+			uint64_t wrong = 0;
+			for (uint32_t i = 0; variant < 2 && i < BENCH_FD_COUNT; ++i) {
+				uint64_t q; uint32_t r;
+				if (variant == 0) fastdiv_u32_divmod(&fd, x[i], &q, &r);
+				else              bench_divmod_1x(&fd, x[i], &q, &r);
+				wrong += (q != x[i] / d || r != x[i] % d);
+			}
+
+			for (uint32_t i = 0; variant >= 3 && i < BENCH_FD_COUNT; ++i) {
+				uint64_t y = x[i];
+				int dv_ok = (variant == 3) ? fastdiv_u32_divide_if_divisible(&fd, &y) : exactdiv_divide_if_divisible(&xd, &y);
+				wrong += (dv_ok != (x[i] % d == 0)) || (dv_ok && y != x[i] / d);
+			}
+
+			static const char* const name[] = { "fastdiv", "fastdiv_1x", "hwdiv", "fastdiv_test", "exactdiv_test" };
+			if (variant == 2) wrong = (acc == 0);   // keeps the loop live
+			bench_row("fastdiv", name[variant], d, 0, 0, ops, us, wrong);
+		}
+	}
+	free(x);
+}
+
+// ------------------------------------------------------------
+// sieve / scan: one worker on a one-thread SCHED_CONTIG epoch
+// ------------------------------------------------------------
+
+static void bench_begin(JobSystem* js, WorkerCtx* w, uint32_t kernel, uint32_t k, uint32_t tile_len, uint64_t x_hi) {
+	js->epoch.kernel = kernel;
+	find_begin_k(js, k, tile_len);
+	if (kernel == KERNEL_LOG) epoch_update_log_scale(&js->epoch, x_hi);
+	ensure_worker_find(w, &js->epoch, tile_len);
+}
+
+static uint64_t bench_sieve_tile(WorkerCtx* w, uint64_t base) {
+	const Epoch* e = &w->js->epoch;
+	const EpochTables* t = &e->tab[w->node];
+	uint32_t n = e->tile_len;
+
+	if      (e->kernel == KERNEL_LOG)  sieve_window_bad_bits_log(e, t, base + 1, n, w->off, w->logs, w->bad_bits);
+	else if (e->kernel == KERNEL_LEAN) sieve_window_bad_bits_lean(e, t, base + 1, n, w->off, w->lean, w->bad_bits);
+	else                               sieve_window_bad_bits_carried_fastdiv(e, t, base + 1, n, w->off, &w->br, w->residual, w->bad_bits);
+	worker_advance_offsets(w, base + 1);
+	return bench_count_bits(w->bad_bits, n);
+}
+
+static void bench_sieve(const BenchCfg* c, JobSystem* js, WorkerCtx* w, uint32_t kernel, uint32_t k, uint32_t tile_len, uint64_t m0) {
+	bench_begin(js, w, kernel, k, tile_len, m0 + (uint64_t)(BENCH_SIEVE_TILES + 1) * tile_len);
+
+	uint64_t ops = 0, smooth = 0, us = 0;
+	do {
+		uint64_t base = m0;
+		worker_init_offsets(w, base + 1);
+		uint64_t t0 = sys_now_us();
+		smooth = 0;
+		for (uint32_t i = 0; i < BENCH_SIEVE_TILES; ++i, base += tile_len) smooth += bench_sieve_tile(w, base);
+		us += sys_now_us() - t0;
+		ops += (uint64_t)BENCH_SIEVE_TILES * tile_len;
+	} while (us < (uint64_t)c->ms * 1000u);
+
+	bench_row("sieve", bench_kernel_name[kernel], k, tile_len, m0, ops, us, smooth);
+	find_end_k(js);
+}
+
+static void bench_scan(const BenchCfg* c, JobSystem* js, WorkerCtx* w, uint32_t kernel, uint32_t k, uint32_t tile_len, uint64_t m) {
+	uint64_t back = (uint64_t)BENCH_SCAN_TILES * tile_len;
+	uint64_t base0 = (m > back) ? m - back : 0;
+	bench_begin(js, w, kernel, k, tile_len, m + (uint64_t)tile_len + k);
+
+	const Epoch* e = &js->epoch;
+	uint64_t ops = 0, found = UINT64_MAX, t0 = sys_now_us(), us;
+	do {
+		ZeroRun run = { 0 };
+		uint64_t base = base0;
+		worker_init_offsets(w, base + 1);
+		for (found = UINT64_MAX; found == UINT64_MAX && base <= m + k; base += tile_len) {
+			found = scan_tile_find_m_carried_fastdiv(e, &e->tab[w->node], base, tile_len, w->off, &w->br, w->residual, w->logs, w->lean, w->wide, w->bad_bits, &run);
+			worker_advance_offsets(w, base + 1);
+			ops += tile_len;
+		}
+		us = sys_now_us() - t0;
+	} while (us < (uint64_t)c->ms * 1000u);
+
+	bench_row("scan", bench_kernel_name[kernel], k, tile_len, m, ops, us, found);
+	find_end_k(js);
+}
+
+int main(int argc, char** argv) {
+	BenchCfg c;
+	memset(&c, 0, sizeof(c));
+	c.k_count = bench_list("20,100,500,2000", c.k);
+	c.tile_count = bench_list("16384,65536,262144", c.tile);
+	c.ms = 300;
+	const char* csv = "km_plateaus.csv";
+	const char* only = NULL;
+	uint32_t simd_max = SIMD_AVX512;
+
+	for (int a = 1; a < argc; ++a) {
+		const char* arg = argv[a];
+		if      (strncmp(arg, "--csv=", 6) == 0)  csv = arg + 6;
+		else if (strncmp(arg, "--k=", 4) == 0)    c.k_count = bench_list(arg + 4, c.k);
+		else if (strncmp(arg, "--tile=", 7) == 0) c.tile_count = bench_list(arg + 7, c.tile);
+		else if (strncmp(arg, "--ms=", 5) == 0)   c.ms = (uint32_t)strtoul(arg + 5, 0, 10);
+		else if (strncmp(arg, "--only=", 7) == 0) only = arg + 7;
+		else if (strncmp(arg, "--simd=", 7) == 0) {
+			const char* v = arg + 7;
+			if      (strcmp(v, "scalar") == 0) simd_max = SIMD_SCALAR;
+			else if (strcmp(v, "avx2") == 0)   simd_max = SIMD_AVX2;
+			else if (strcmp(v, "avx512") == 0 || strcmp(v, "auto") == 0) simd_max = SIMD_AVX512;
+			else { fprintf(stderr, "unknown --simd level: %s\n", v); return 1; }
+		}
+		else {
+			fprintf(stderr, "unexpected argument: %s\n", arg);
+			return 1;
+		}
+	}
+
+	simd_init(simd_max, 0);
+	wheel_init();
+	lean_init();
+
+	printf("bench,variant,simd,param,tile_len,m0,ops,ns_per_op,check\n");
+	if (!only || strcmp(only, "fastdiv") == 0) bench_fastdiv(&c);
+	if (only && strcmp(only, "sieve") != 0 && strcmp(only, "scan") != 0) return 0;
+
+	bench_read_seeds(&c, csv);
+
+	JobSystem js;
+	memset(&js, 0, sizeof(js));
+	js.thread_count = 1;
+	js.epoch.schedule = SCHED_CONTIG;
+	js.epoch.node_count = 1;
+
+	WorkerCtx w;
+	memset(&w, 0, sizeof(w));
+	w.js = &js;
+
+	for (uint32_t ki = 0; ki < c.k_count; ++ki) {
+		uint32_t k = c.k[ki];
+		uint64_t m = bench_m_of_k(&c, k);
+		if (m == UINT64_MAX) {
+			fprintf(stderr, "; k=%u is past %s, skipped\n", k, csv);
+			continue;
+		}
+		for (uint32_t ti = 0; ti < c.tile_count; ++ti)
+			for (uint32_t kernel = KERNEL_EXACT; kernel <= KERNEL_LEAN; ++kernel) {
+				if (!only || strcmp(only, "sieve") == 0) bench_sieve(&c, &js, &w, kernel, k, c.tile[ti], m);
+				if (!only || strcmp(only, "scan") == 0)  bench_scan(&c, &js, &w, kernel, k, c.tile[ti], m);
+			}
+	}
+
+	sys_free(w.residual);
+	sys_free(w.bad_bits);
+	sys_free(w.off);
+	sys_free(w.logs);
+	sys_free(w.lean);
+	epoch_free_tables(&js.epoch);
+	free(c.seed_k);
+	free(c.seed_m);
+	return 0;
+}
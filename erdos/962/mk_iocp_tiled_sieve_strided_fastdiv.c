@@ -1,36 +1,157 @@
 // mk_iocp_tiled_sieve_strided_fastdiv.c
 //
 // Strided tiling + carried offsets + FastDiv (mulhi) to reduce idiv usage.
-// - Workers block on GetQueuedCompletionStatus()
+// - Workers block on GetQueuedCompletionStatus(); each KEY_START packet carries its stride lane
 // - Minimality preserved: best_m shrinks end_limit; epoch completes when all workers exhaust <= end_limit
 // - Strided tile assignment: no global atomic allocator hotspot
 // - Carried offsets: removes per-tile base%p
-// - FastDiv: removes idiv from the inner "divide out p factors" loop for odd primes
+// - FastDiv: removes idiv from offset setup and p^2 positions; the inner "divide out p
+//   factors" loop uses exact-division inverses instead (p | x iff x * p^-1 <= UINT64_MAX/p,
+//   and the product is the quotient: one multiply, one compare, no correction)
+// - Sweep mode: one pass over m for all k <= K, tracking the largest prime factor of smooth values
+// - Bucket sieve (contiguous lanes): primes >= window length are touched only by tiles they hit
+// - Log kernel: uint8 log2 sums per prime-power hit; exact FastDiv trial only on candidates
+// - Lean kernel (find mode): the value stays implicit, a u32 per position packs the stripped
+//   odd part mod 2^24 and a quarter-bit log2; exact, with half the working set of the residual
+// - SIMD (AVX2 / AVX-512, CPUID dispatch): residual init, ==1 -> bits, small-prime stage, window scan
+// - Word-level run finder (tzcnt/lzcnt) with a carried gap: contiguous lanes sieve every value once,
+//   and runs crossing lane/epoch boundaries are stitched from per-lane head/tail counts
+// - Wheel pre-sieve: 2 by ctz, 3..13 by one multiply with a per-residue inverse (period 15015),
+//   squares by stride; exact and sweep kernels start striding at 17
+// - Platform layer: Win32 (IOCP, processor groups) or POSIX (pthreads, condvar job queue,
+//   C11 atomics, mmap + THP hint, one pinned CPU per worker)
+// - Placement: workers pinned one per physical core before any SMT sibling, slower
+//   efficiency classes last (or off, or alone), the default tile_len from each worker's L2
+//   share; process priority low, idle or normal
+// - NUMA: worker buffers come from the worker's node (large pages when the account may
+//   lock memory), and the per-k prime/FastDiv tables are replicated per node
+// - Work stealing (optional): per-lane tile ranges that idle workers split from the top,
+//   so one slow core no longer holds the epoch open
+// - Checkpoint/resume (find mode): the search frontier and plateau list, rewritten atomically
+// - Distributed find mode: a coordinator leases m-ranges per k to nodes over TCP, keeps
+//   min(best), pushes the shrinking limit back, and reissues ranges of lost nodes
+// - Skip index (find mode): the clear run at m(k-1) settles plateau k without an epoch and
+//   gives the search for a jump a start past its first break
+// - Pipelined epochs: EPOCH_DEPTH batches in flight, so workers flow into the next batch
+//   (and keep their offsets) instead of idling at a barrier; later finds are held back
+// - Auto-tune (find mode): tile_len chosen per k range from timed calibration spans, with
+//   candidates sized to the reported L1d/L2
+// - Run statistics: per-worker tiles, values/s and idle time, the main thread's barrier
+//   wait, a periodic heartbeat with the frontier m, and a per-k breakdown (text or JSON)
+// - Batch verifier: every row of a plateau CSV checked against its k on the worker pool;
+//   its true plateau length comes from one pass of largest prime factors over a window
+//   that doubles while the run lasts
+// - Wide kernel (local find mode): positions stay u64 offsets from a u128 origin that moves
+//   up to the frontier at 2^62 (-DWIDE_REBASE_AT); from then on windows use a u128 residual
+//   with inverses mod 2^128, so m goes past 2^64 and the 64-bit path keeps its speed before
+// - Seeded find (--seed): a known plateau table (CSV or .kmp) stands in for the replay from
+//   k = 1, with an optional spot check of some rows by the same search
 //
 // Build (clang-cl, x64 dev prompt):
-//   clang-cl /nologo /O2 /W4 /GS- mk_iocp_tiled_sieve_strided_fastdiv.c /link kernel32.lib /OPT:REF /OPT:ICF /lld
+//   clang-cl /nologo /O2 /W4 /GS- mk_iocp_tiled_sieve_strided_fastdiv.c /link kernel32.lib advapi32.lib ws2_32.lib /OPT:REF /OPT:ICF /lld
 //
 // Build (clang, in VS dev prompt):
-//   clang -O3 -std=c11 -march=native mk_iocp_tiled_sieve_strided_fastdiv.c -o mk.exe -lkernel32 -fuse-ld=lld
+//   clang -O3 -std=c11 -march=native mk_iocp_tiled_sieve_strided_fastdiv.c -o mk.exe -lkernel32 -ladvapi32 -lws2_32 -fuse-ld=lld
+//
+// Build (Linux / POSIX):
+//   cc -O3 -std=c11 -march=native mk_iocp_tiled_sieve_strided_fastdiv.c -o mk -lpthread -lm
 //
 // Usage:
-//   mk.exe [K=200] [threads=0=HW] [tile_len=65536] [batch_tiles=128]
-
+//   mk.exe [K=200] [threads=0=cores] [tile_len=0=L2] [batch_tiles=128] [--sweep] [--contig] [--bucket] [--log|--lean]
+//        [--steal] [--simd=auto|scalar|avx2|avx512] [--simd-small] [--checkpoint=FILE [--resume]]
+//        [--smt] [--ecores=last|off|only] [--priority=low|idle|normal]
+//        [--serve=PORT [--lease=600] | --connect=HOST:PORT] [--skip] [--tune] [--stats[=10] [--json]]
+//        [--bin=FILE] [--verify=FILE] [--seed=FILE [--seed-check=N]]
+//
+//   threads   0: one worker per physical core; workers take every core before a second
+//             logical CPU of any core, and are pinned in that order
+//   tile_len  0: the kernel's working set at half of one worker's share of its L2
+//   --smt     threads 0 takes every logical CPU (SMT siblings after all the cores)
+//   --ecores  hybrid parts: slower efficiency classes after the fastest (last, default),
+//             not at all (off), or alone (only, to leave the fast cores to the desktop)
+//   --priority  low: below normal (default); idle: idle time only; normal: unchanged, so
+//             the run is not starved by other background load
+//   --sweep   sieve each integer once against primes <= K and emit every plateau k <= K,
+//             instead of restarting find_m_for_k (and its prime tables) for every k
+//   --contig  each worker scans one contiguous run of tiles per epoch instead of a stride;
+//             every integer is sieved exactly once (no +k overlap between tiles or lanes)
+//   --bucket  bucket sieve for primes >= window length (implies --contig); pays off once
+//             tiles are shrunk below K, e.g. --sweep with tile_len 4096..16384
+//   --log     log-approximation kernel: 1 byte per position instead of a u64 residual
+//   --lean    exact 4-byte kernel for find mode (no buckets); larger tiles stay in L2
+//   --steal   contiguous tile ranges per worker with work stealing at the epoch tail; find
+//             tiles keep their +k overlap (no run stitching), and there is no bucket sieve
+//   --simd    cap the CPUID-selected SIMD level (default auto; the choice is printed to stderr)
+//   --simd-small  also strip p < 64 with the vector pattern stage; its vpmullq chain is
+//             latency bound, so it only pays on cores with a fast 64-bit multiply (Zen 4)
+//   --checkpoint  save k, the confirmed m frontier and the plateau points to FILE about
+//             once a minute (find mode only); --resume reprints them and carries on
+//   --serve   coordinate a distributed find: no local sieving, ranges of tile_len*batch_tiles
+//             starts go to nodes; a node silent for --lease seconds loses its range
+//   --connect run as a node of that coordinator (K is taken from it; threads, tiles and
+//             scheduling flags are the node's own)
+//   --skip    trial-sieve the K+1 values after each m(k) once and answer the following k from
+//             them while the clear run still reaches k; a search starts past the run's break
+//   --tune    time tile_len candidates from the L1d/L2 sizes on real search spans, at the
+//             first search and again whenever k doubles; batch_tiles keeps the batch span
+//   --stats   to stderr: a heartbeat every SEC seconds (0: none), a line per k in find mode
+//             and a run total with one line per worker; build with -DSTATS_HOT=1 to also
+//             count prime hits and second FastDiv corrections
+//   --json    the --stats lines as one JSON object each (implies --stats, no heartbeat)
+//   --bin     also write the plateau points to FILE as fixed-width records with an m index
+//             (see "Plateau file" below; kmp.py reads it and answers k(n) by bisection)
+//   --verify  check every (k, m) row of a plateau CSV instead of searching (K is ignored):
+//             prints each row's true length and whether the next k continues it, and
+//             exits 1 on a failed row or a gap; --log, --lean and --bucket do not apply
+//   --seed    take m(k) from the plateau points of FILE (CSV or .kmp, from k = 1), reprint
+//             them, and search on from the last row's k + 1 and m instead of from k = 1
+//   --seed-check  first search N of those rows again (the last one included), each from
+//             the row before it, and stop if one differs
+
+#ifdef _WIN32
 #define WIN32_LEAN_AND_MEAN
+#define FD_SETSIZE 256          // coordinator: one socket per node
+#include <winsock2.h>
+#include <ws2tcpip.h>
 #include <windows.h>
+#include <io.h>                 // _commit
+#else
+#define _GNU_SOURCE             // pthread_attr_setaffinity_np, CPU_* macros
+#include <pthread.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sched.h>
+#include <signal.h>
+#include <stdatomic.h>
+#include <sys/mman.h>
+#include <sys/resource.h>
+#include <sys/select.h>
+#include <sys/socket.h>
+#include <sys/syscall.h>            // SYS_mbind
+#include <time.h>
+#include <unistd.h>
+#endif
 #include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <math.h>
+#include <immintrin.h>
+#if defined(__clang__) || defined(__GNUC__)
+#include <cpuid.h>
+#endif
 
 #if defined(__clang__) || defined(__GNUC__)
 #define FORCEINLINE __attribute__((always_inline)) inline
 #define LIKELY(x)   __builtin_expect(!!(x), 1)
 #define UNLIKELY(x) __builtin_expect(!!(x), 0)
+#define TARGET(t)   __attribute__((target(t)))
 #else
 #define FORCEINLINE __forceinline
 #define LIKELY(x)   (x)
 #define UNLIKELY(x) (x)
+#define TARGET(t)
 #endif
 
 #ifndef FASTDIV_2X_CORRECT
@@ -38,6 +159,309 @@
 #define FASTDIV_2X_CORRECT 1
 #endif
 
+#ifndef STATS_HOT
+// Set to 1 to also count prime hits and FastDiv corrections for --stats (a few % slower).
+#define STATS_HOT 0
+#endif
+
+// ------------------------------------------------------------
+// Platform layer: Win32 (IOCP, Interlocked*, VirtualAlloc, processor groups, Winsock)
+// or POSIX (pthreads + condvar job queue, C11 atomics, mmap, sched affinity, BSD sockets)
+// ------------------------------------------------------------
+//
+// The job model is the same on both: the main thread posts one (key, lane) packet per
+// worker, workers block in jobq_wait, and the last worker of an epoch sets evt_done.
+//
+
+#ifndef SYS_MAX_NODES
+#define SYS_MAX_NODES 16        // table replicas; workers on higher nodes share node 0's
+#endif
+#define SYS_NODE_ANY UINT32_MAX
+#ifndef SYS_CPU_ROOT
+#define SYS_CPU_ROOT "/sys/devices/system/cpu"   // POSIX topology and caches (sysfs)
+#endif
+
+enum { PRIORITY_LOW = 0, PRIORITY_IDLE = 1, PRIORITY_NORMAL = 2 };   // --priority
+
+#ifdef _WIN32
+
+typedef volatile LONG64 shared_u64;
+typedef volatile LONG   shared_u32;
+
+static FORCEINLINE uint64_t load_u64(shared_u64* p) { return (uint64_t)InterlockedCompareExchange64(p, 0, 0); }
+static FORCEINLINE void store_u64(shared_u64* p, uint64_t v) { InterlockedExchange64(p, (LONG64)v); }
+static FORCEINLINE int cas_u64(shared_u64* p, uint64_t expect, uint64_t v) {
+	return InterlockedCompareExchange64(p, (LONG64)v, (LONG64)expect) == (LONG64)expect;
+}
+static FORCEINLINE void store_u32(shared_u32* p, uint32_t v) { InterlockedExchange(p, (LONG)v); }
+static FORCEINLINE uint32_t dec_u32(shared_u32* p) { return (uint32_t)InterlockedDecrement(p); }
+
+static SIZE_T g_large_page;   // GetLargePageMinimum() once SeLockMemoryPrivilege is enabled
+
+// Large pages need the "Lock pages in memory" right; without it allocations stay 4K.
+static void sys_memory_init(void) {
+	HANDLE tok;
+	if (!OpenProcessToken(GetCurrentProcess(), TOKEN_ADJUST_PRIVILEGES | TOKEN_QUERY, &tok)) return;
+
+	TOKEN_PRIVILEGES tp = { 0 };
+	tp.PrivilegeCount = 1;
+	tp.Privileges[0].Attributes = SE_PRIVILEGE_ENABLED;
+	if (LookupPrivilegeValueA(NULL, "SeLockMemoryPrivilege", &tp.Privileges[0].Luid)
+		&& AdjustTokenPrivileges(tok, FALSE, &tp, 0, NULL, NULL) && GetLastError() == ERROR_SUCCESS)
+		g_large_page = GetLargePageMinimum();
+	CloseHandle(tok);
+}
+
+// Pages on NUMA node (SYS_NODE_ANY: the faulting thread's); blocks of a large page or
+// more are rounded up to large pages when that is possible.
+static void* sys_alloc_node(size_t bytes, uint32_t node) {
+	DWORD nd = (node == SYS_NODE_ANY) ? NUMA_NO_PREFERRED_NODE : (DWORD)node;
+	if (g_large_page && bytes >= g_large_page) {
+		SIZE_T len = (bytes + g_large_page - 1) & ~(g_large_page - 1);
+		void* p = VirtualAllocExNuma(GetCurrentProcess(), NULL, len, MEM_RESERVE | MEM_COMMIT | MEM_LARGE_PAGES, PAGE_READWRITE, nd);
+		if (p) return p;
+	}
+	return VirtualAllocExNuma(GetCurrentProcess(), NULL, bytes, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE, nd);
+}
+static void* sys_alloc(size_t bytes) { return sys_alloc_node(bytes, SYS_NODE_ANY); }
+static void sys_free(void* p) {
+	if (p) VirtualFree(p, 0, MEM_RELEASE);
+}
+
+typedef struct JobQueue { HANDLE iocp; } JobQueue;
+
+static int jobq_init(JobQueue* q, uint32_t threads) {
+	q->iocp = CreateIoCompletionPort(INVALID_HANDLE_VALUE, NULL, 0, threads);
+	if (!q->iocp) fprintf(stderr, "CreateIoCompletionPort failed: %lu\n", GetLastError());
+	return q->iocp != NULL;
+}
+static void jobq_post(JobQueue* q, uint32_t key, uint32_t lane) {
+	PostQueuedCompletionStatus(q->iocp, (DWORD)lane, (ULONG_PTR)key, NULL);
+}
+static void jobq_wait(JobQueue* q, uint32_t* key, uint32_t* lane) {
+	DWORD bytes = 0;
+	ULONG_PTR k = 0;
+	LPOVERLAPPED ov = NULL;
+	GetQueuedCompletionStatus(q->iocp, &bytes, &k, &ov, INFINITE);
+	*key = (uint32_t)k;
+	*lane = (uint32_t)bytes;
+}
+static void jobq_free(JobQueue* q) { CloseHandle(q->iocp); }
+
+typedef struct SysEvent { HANDLE h; } SysEvent;   // manual reset
+
+static int event_init(SysEvent* ev) {
+	ev->h = CreateEventW(NULL, TRUE, FALSE, NULL);
+	if (!ev->h) fprintf(stderr, "CreateEvent failed: %lu\n", GetLastError());
+	return ev->h != NULL;
+}
+static void event_set(SysEvent* ev)   { SetEvent(ev->h); }
+static void event_reset(SysEvent* ev) { ResetEvent(ev->h); }
+static void event_wait(SysEvent* ev)  { WaitForSingleObject(ev->h, INFINITE); }
+static void event_free(SysEvent* ev)  { CloseHandle(ev->h); }
+
+typedef HANDLE SysThread;
+
+// LOW: below normal, and so are the workers (worker_thread); IDLE: idle time only;
+// NORMAL: left as started.
+static void sys_set_priority(uint32_t prio) {
+	if (prio == PRIORITY_LOW)  SetPriorityClass(GetCurrentProcess(), BELOW_NORMAL_PRIORITY_CLASS);
+	if (prio == PRIORITY_IDLE) SetPriorityClass(GetCurrentProcess(), IDLE_PRIORITY_CLASS);
+}
+
+static uint64_t sys_now_ms(void) { return GetTickCount64(); }
+static uint64_t sys_now_us(void) {
+	static LARGE_INTEGER f;
+	LARGE_INTEGER c;
+	if (!f.QuadPart) QueryPerformanceFrequency(&f);
+	QueryPerformanceCounter(&c);
+	return (uint64_t)(c.QuadPart / f.QuadPart) * 1000000u + (uint64_t)(c.QuadPart % f.QuadPart) * 1000000u / (uint64_t)f.QuadPart;
+}
+
+// Flush f to disk, close it, and move tmp over path in one step.
+static int sys_commit_file(FILE* f, const char* tmp, const char* path) {
+	int ok = (fflush(f) == 0) && (_commit(_fileno(f)) == 0);
+	ok = (fclose(f) == 0) && ok;
+	return ok && MoveFileExA(tmp, path, MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH);
+}
+
+static void sys_sleep_ms(uint32_t ms) { Sleep(ms); }
+
+typedef SOCKET SysSock;
+#define SYS_SOCK_BAD INVALID_SOCKET
+
+static int sys_net_init(void) {
+	WSADATA wsa;
+	return WSAStartup(MAKEWORD(2, 2), &wsa) == 0;
+}
+static void sys_sock_close(SysSock s) { closesocket(s); }
+
+#else // POSIX
+
+typedef _Atomic uint64_t shared_u64;
+typedef _Atomic uint32_t shared_u32;
+
+static FORCEINLINE uint64_t load_u64(shared_u64* p) { return atomic_load_explicit(p, memory_order_acquire); }
+static FORCEINLINE void store_u64(shared_u64* p, uint64_t v) { atomic_store_explicit(p, v, memory_order_release); }
+static FORCEINLINE int cas_u64(shared_u64* p, uint64_t expect, uint64_t v) {
+	return atomic_compare_exchange_strong_explicit(p, &expect, v, memory_order_acq_rel, memory_order_acquire);
+}
+static FORCEINLINE void store_u32(shared_u32* p, uint32_t v) { atomic_store_explicit(p, v, memory_order_release); }
+static FORCEINLINE uint32_t dec_u32(shared_u32* p) { return atomic_fetch_sub_explicit(p, 1, memory_order_acq_rel) - 1; }
+
+// mmap with the length kept in a 64-byte header (munmap needs it); large blocks ask for
+// transparent huge pages. Linux places pages where they are first touched, which is the
+// worker's own node for its buffers; a node is bound explicitly (before the header write)
+// for blocks that another thread fills, like the table replicas.
+#define SYS_ALLOC_HDR 64u
+#define SYS_HUGE_MIN  ((size_t)2 << 20)
+
+static void sys_memory_init(void) {}
+
+static void* sys_alloc_node(size_t bytes, uint32_t node) {
+	size_t len = bytes + SYS_ALLOC_HDR;
+	uint8_t* p = (uint8_t*)mmap(NULL, len, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+	if (p == MAP_FAILED) return NULL;
+#ifdef SYS_mbind
+	if (node != SYS_NODE_ANY) {
+		unsigned long mask = 1ul << node;
+		syscall(SYS_mbind, p, len, 1 /* MPOL_PREFERRED */, &mask, (unsigned long)SYS_MAX_NODES + 1, 0u);
+	}
+#endif
+#ifdef MADV_HUGEPAGE
+	if (len >= SYS_HUGE_MIN) madvise(p, len, MADV_HUGEPAGE);
+#endif
+	memcpy(p, &len, sizeof(len));
+	return p + SYS_ALLOC_HDR;
+}
+static void* sys_alloc(size_t bytes) { return sys_alloc_node(bytes, SYS_NODE_ANY); }
+static void sys_free(void* q) {
+	if (!q) return;
+	uint8_t* p = (uint8_t*)q - SYS_ALLOC_HDR;
+	size_t len;
+	memcpy(&len, p, sizeof(len));
+	munmap(p, len);
+}
+
+// (key, lane) packets in a ring; a condvar stands in for the completion port.
+typedef struct JobPacket { uint32_t key, lane; } JobPacket;
+
+typedef struct JobQueue {
+	pthread_mutex_t mu;
+	pthread_cond_t  not_empty;
+	pthread_cond_t  not_full;
+	JobPacket* ring;
+	uint32_t cap, head, count;
+} JobQueue;
+
+static int jobq_init(JobQueue* q, uint32_t threads) {
+	q->cap = 2 * threads + 16;
+	q->head = q->count = 0;
+	q->ring = (JobPacket*)calloc(q->cap, sizeof(JobPacket));
+	if (!q->ring) { fprintf(stderr, "calloc failed for job queue\n"); return 0; }
+	pthread_mutex_init(&q->mu, NULL);
+	pthread_cond_init(&q->not_empty, NULL);
+	pthread_cond_init(&q->not_full, NULL);
+	return 1;
+}
+static void jobq_post(JobQueue* q, uint32_t key, uint32_t lane) {
+	pthread_mutex_lock(&q->mu);
+	while (q->count == q->cap) pthread_cond_wait(&q->not_full, &q->mu);
+	uint32_t t = q->head + q->count;
+	if (t >= q->cap) t -= q->cap;
+	q->ring[t].key = key;
+	q->ring[t].lane = lane;
+	++q->count;
+	pthread_cond_signal(&q->not_empty);
+	pthread_mutex_unlock(&q->mu);
+}
+static void jobq_wait(JobQueue* q, uint32_t* key, uint32_t* lane) {
+	pthread_mutex_lock(&q->mu);
+	while (q->count == 0) pthread_cond_wait(&q->not_empty, &q->mu);
+	*key = q->ring[q->head].key;
+	*lane = q->ring[q->head].lane;
+	if (++q->head == q->cap) q->head = 0;
+	--q->count;
+	pthread_cond_signal(&q->not_full);
+	pthread_mutex_unlock(&q->mu);
+}
+static void jobq_free(JobQueue* q) {
+	pthread_cond_destroy(&q->not_full);
+	pthread_cond_destroy(&q->not_empty);
+	pthread_mutex_destroy(&q->mu);
+	free(q->ring);
+}
+
+typedef struct SysEvent {   // manual reset
+	pthread_mutex_t mu;
+	pthread_cond_t  cv;
+	int set;
+} SysEvent;
+
+static int event_init(SysEvent* ev) {
+	ev->set = 0;
+	pthread_mutex_init(&ev->mu, NULL);
+	pthread_cond_init(&ev->cv, NULL);
+	return 1;
+}
+static void event_set(SysEvent* ev) {
+	pthread_mutex_lock(&ev->mu);
+	ev->set = 1;
+	pthread_cond_broadcast(&ev->cv);
+	pthread_mutex_unlock(&ev->mu);
+}
+static void event_reset(SysEvent* ev) {
+	pthread_mutex_lock(&ev->mu);
+	ev->set = 0;
+	pthread_mutex_unlock(&ev->mu);
+}
+static void event_wait(SysEvent* ev) {
+	pthread_mutex_lock(&ev->mu);
+	while (!ev->set) pthread_cond_wait(&ev->cv, &ev->mu);
+	pthread_mutex_unlock(&ev->mu);
+}
+static void event_free(SysEvent* ev) {
+	pthread_cond_destroy(&ev->cv);
+	pthread_mutex_destroy(&ev->mu);
+}
+
+typedef pthread_t SysThread;
+
+static void sys_set_priority(uint32_t prio) {
+	// nice is per thread on Linux; workers created after this inherit it
+	if (prio != PRIORITY_NORMAL) setpriority(PRIO_PROCESS, 0, (prio == PRIORITY_IDLE) ? 19 : 10);
+}
+
+static uint64_t sys_now_ms(void) {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * 1000u + (uint64_t)ts.tv_nsec / 1000000u;
+}
+static uint64_t sys_now_us(void) {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * 1000000u + (uint64_t)ts.tv_nsec / 1000u;
+}
+
+static int sys_commit_file(FILE* f, const char* tmp, const char* path) {
+	int ok = (fflush(f) == 0) && (fsync(fileno(f)) == 0);
+	ok = (fclose(f) == 0) && ok;
+	return ok && rename(tmp, path) == 0;
+}
+
+static void sys_sleep_ms(uint32_t ms) { usleep((useconds_t)ms * 1000u); }
+
+typedef int SysSock;
+#define SYS_SOCK_BAD (-1)
+
+static int sys_net_init(void) {
+	signal(SIGPIPE, SIG_IGN);   // a lost peer shows up as a send() error instead
+	return 1;
+}
+static void sys_sock_close(SysSock s) { close(s); }
+
+#endif
+
 // ------------------------------------------------------------
 // FastDivU32 (u64 / u32, u64 % u32) using mulhi + 1-2 corrections
 // ------------------------------------------------------------
@@ -55,6 +479,20 @@ static FORCEINLINE uint64_t mulhi_u64(uint64_t a, uint64_t b) {
 #endif
 }
 
+typedef __uint128_t u128;   // values past 2^64 (Epoch.origin); multiplies only, no division helpers
+
+#if STATS_HOT
+#ifdef _MSC_VER
+#define THREAD_LOCAL __declspec(thread)
+#else
+#define THREAD_LOCAL __thread
+#endif
+static THREAD_LOCAL uint64_t g_fd_fix;   // second corrections taken by this thread
+#define STAT_FD_FIX() (++g_fd_fix)
+#else
+#define STAT_FD_FIX() ((void)0)
+#endif
+
 static FORCEINLINE FastDivU32 fastdiv_u32_make_prime(uint32_t d) {
 	FastDivU32 fd;
 	fd.d = d;
@@ -71,7 +509,7 @@ static FORCEINLINE void fastdiv_u32_divmod(const FastDivU32* fd, uint64_t n, uin
 
 	if (rr >= d) { rr -= d; ++q0; }
 #if FASTDIV_2X_CORRECT
-	if (rr >= d) { rr -= d; ++q0; }
+	if (rr >= d) { rr -= d; ++q0; STAT_FD_FIX(); }
 #endif
 
 	* q = q0;
@@ -92,6 +530,98 @@ static FORCEINLINE int fastdiv_u32_divide_if_divisible(const FastDivU32* fd, uin
 	return 1;
 }
 
+// n % d for a u128 numerator: the high word first, then the low word in 32-bit limbs, so
+// every step is a u64 numerator below d * 2^32.
+static FORCEINLINE uint32_t fastdiv_u32_mod_u128(const FastDivU32* fd, u128 n) {
+	uint64_t hi = (uint64_t)(n >> 64), lo = (uint64_t)n;
+	if (LIKELY(hi == 0)) return fastdiv_u32_mod(fd, lo);
+	uint64_t r = fastdiv_u32_mod(fd, hi);
+	r = fastdiv_u32_mod(fd, (r << 32) | (lo >> 32));
+	return fastdiv_u32_mod(fd, (r << 32) | (lo & 0xFFFFFFFFull));
+}
+
+// n / d by 32-bit limbs (clang-cl links no __udivti3); cold paths only.
+static u128 u128_divmod_u32(u128 n, uint32_t d, uint32_t* rem) {
+	u128 q = 0;
+	uint64_t r = 0;
+	for (int s = 96; s >= 0; s -= 32) {
+		uint64_t t = (r << 32) | (uint64_t)((n >> s) & 0xFFFFFFFFu);
+		q |= (u128)(t / d) << s;
+		r = t % d;
+	}
+	if (rem) *rem = (uint32_t)r;
+	return q;
+}
+
+// Decimal digits of v; buf holds 40 chars (2^128 has 39 digits).
+static const char* u128_str(char* buf, u128 v) {
+	char* s = buf + 39;
+	*s = 0;
+	do {
+		uint32_t d;
+		v = u128_divmod_u32(v, 10, &d);
+		*--s = (char)('0' + d);
+	} while (v);
+	return s;
+}
+
+// ------------------------------------------------------------
+// ExactDivU64: divisibility by odd p with the inverse mod 2^64
+// ------------------------------------------------------------
+//
+// For odd p, x -> x * p^-1 (mod 2^64) maps the multiples of p onto 0 .. UINT64_MAX/p (as
+// their quotients) and everything else above it. One multiply and one compare decide
+// p | x, and the product is already x / p: no quotient estimate and no correction.
+//
+
+typedef struct ExactDivU64 {
+	uint64_t inv;   // p^-1 mod 2^64
+	uint64_t lim;   // UINT64_MAX / p
+} ExactDivU64;
+
+static uint64_t inverse_u64(uint64_t p) {
+	uint64_t inv = p;                       // good to 3 bits for odd p; Newton doubles it
+	for (int i = 0; i < 5; ++i) inv *= 2 - p * inv;
+	return inv;
+}
+
+// p == 2 gets an entry that never divides (2 is stripped by ctz everywhere).
+static ExactDivU64 exactdiv_make(uint32_t p) {
+	ExactDivU64 d;
+	d.inv = (p & 1) ? inverse_u64(p) : 1;
+	d.lim = (p & 1) ? UINT64_MAX / p : 0;
+	return d;
+}
+
+static FORCEINLINE int exactdiv_divide_if_divisible(const ExactDivU64* d, uint64_t* x_io) {
+	uint64_t q = *x_io * d->inv;
+	if (LIKELY(q > d->lim)) return 0;
+	*x_io = q;
+	return 1;
+}
+
+// The same test mod 2^128 for the wide kernel (one more Newton step, three multiplies).
+typedef struct ExactDivU128 {
+	u128 inv;       // p^-1 mod 2^128
+	u128 lim;       // (2^128 - 1) / p
+} ExactDivU128;
+
+static ExactDivU128 exactdiv128_make(uint32_t p) {
+	ExactDivU128 d;
+	u128 inv = inverse_u64(p);
+	inv *= 2 - (u128)p * inv;
+	d.inv = (p & 1) ? inv : 1;
+	d.lim = (p & 1) ? u128_divmod_u32(~(u128)0, p, NULL) : 0;
+	return d;
+}
+
+static FORCEINLINE int exactdiv128_divide_if_divisible(const ExactDivU128* d, u128* x_io) {
+	u128 q = *x_io * d->inv;
+	if (LIKELY(q > d->lim)) return 0;
+	*x_io = q;
+	return 1;
+}
+
 // ------------------------------------------------------------
 // Prime list up to k
 // ------------------------------------------------------------
@@ -147,400 +677,3554 @@ static FORCEINLINE void bitset_set(uint8_t* bits, uint32_t i) {
 static FORCEINLINE uint32_t bitset_get(const uint8_t* bits, uint32_t i) {
 	return (uint32_t)((bits[i >> 3] >> (i & 7)) & 1u);
 }
+// Index of the first set bit, or bit_count if none.
+static uint32_t bitset_first_set(const uint8_t* bits, uint32_t bit_count) {
+	uint32_t nbytes = (bit_count + 7u) >> 3;
+	for (uint32_t b = 0; b < nbytes; ++b) {
+		if (!bits[b]) continue;
+		uint32_t i = (b << 3) + (uint32_t)__builtin_ctz(bits[b]);
+		return (i < bit_count) ? i : bit_count;
+	}
+	return bit_count;
+}
 
 // ------------------------------------------------------------
-// IOCP epoch system
+// SIMD passes (AVX2 / AVX-512) with CPUID dispatch
 // ------------------------------------------------------------
+//
+// g_simd is chosen once at startup; the scalar entries are the reference loops. The
+// optional small-prime stage strips the odd primes p < 64 (primes[p0..SIMD_SMALL_END)) vector by
+// vector: a per-prime lane pattern says which lanes are multiples, and division is
+// exact, x * p^-1 mod 2^64, repeated while x * p^-1 <= UINT64_MAX / p.
+//
 
-enum { KEY_START = 1, KEY_STOP = 2 };
-
-typedef struct Epoch {
-	uint32_t  k;
-	uint32_t  tile_len;
-	uint64_t  step;         // tile_len * thread_count
+enum { SIMD_SCALAR = 0, SIMD_AVX2 = 1, SIMD_AVX512 = 2 };
+
+#define SIMD_SMALL_END 18   // primes[1..17] = 3..61
+
+// KERNEL_LEAN word: odd smooth part mod 2^24 | quarter-bit log2 sum << 24 (see the lean
+// kernel for why the test below is exact)
+#define LEAN_BITS  24
+#define LEAN_MASK  ((1u << LEAN_BITS) - 1u)
+#define LEAN_SLACK 60u
+
+// 52-bit mantissas of 2^(1/4), 2^(1/2), 2^(3/4): floor(4 log2 x) from a double
+#define LEAN_Q1 0x306FE0A31B715ull
+#define LEAN_Q2 0x6A09E667F3BCDull
+#define LEAN_Q3 0xAE89F995AD3ADull
+
+typedef struct SimdSmallPrime {
+	uint32_t p;
+	uint32_t adv4, adv8;    // lane count % p
+	uint64_t inv;           // p^-1 mod 2^64
+	uint64_t lim;           // UINT64_MAX / p
+	uint8_t  pat4[64];      // [phase] bit j set iff (phase + j) % p == 0, 4 lanes
+	uint8_t  pat8[64];      // same, 8 lanes
+} SimdSmallPrime;
+
+// Clear bits at the end of a bad_bits stream; carried from one window of a lane to the next.
+typedef struct ZeroRun {
+	uint64_t gap;
+} ZeroRun;
+
+typedef struct SimdOps {
+	const char* name;
+	uint32_t lanes;         // u64 lanes of strip_small (unused when strip_small == NULL)
+	void (*iota_u64)(uint64_t* dst, uint64_t base, uint32_t n);
+	void (*ones_to_bits)(const uint64_t* residual, uint32_t n, uint8_t* bits);
+	void (*strip_small)(uint64_t* residual, uint32_t nfull, const uint32_t* off, uint32_t p0, uint32_t ns);
+	uint32_t (*zero_run_feed)(ZeroRun* run, const uint8_t* bits, uint32_t n, uint32_t k);
+	void (*lean_to_bits)(const uint32_t* lean, uint64_t base_test, uint32_t n, uint32_t tzm, uint8_t* bits);
+} SimdOps;
+
+static SimdSmallPrime g_small[SIMD_SMALL_END];
+static SimdOps g_simd;
+
+static FORCEINLINE uint64_t load_u64_bytes(const uint8_t* p, uint32_t avail) {
+	uint64_t w = 0;
+	memcpy(&w, p, avail >= 8 ? 8 : avail);
+	return w;
+}
 
-	uint64_t  start_m;      // inclusive
-	uint64_t  end_m;        // inclusive
+// One word (nb <= 64 valid bits, none set above nb) of the run finder. tzcnt closes the
+// carried gap, lzcnt opens the next one; interior gaps are walked only when k < 64.
+// Returns the bit index where the run first reaches k clear bits, else UINT32_MAX.
+static FORCEINLINE uint32_t zero_run_word(uint64_t* gap, uint64_t w, uint32_t nb, uint32_t k) {
+	if (w == 0) {
+		if (*gap + nb >= k) return (uint32_t)(k - *gap - 1);
+		*gap += nb;
+		return UINT32_MAX;
+	}
 
-	PrimeList primes;
+	uint32_t lo = (uint32_t)__builtin_ctzll(w);
+	if (*gap + lo >= k) return (uint32_t)(k - *gap - 1);
 
-	// Precomputed per-k arrays (same length as primes.count)
-	FastDivU32* fd;         // [prime_count]
-	uint32_t* step_mod;   // [prime_count]  (step % p)
+	uint32_t hi = 63u - (uint32_t)__builtin_clzll(w);
+	if (k < 64) {
+		uint32_t prev = lo;
+		for (uint64_t t = w & (w - 1); t; t &= t - 1) {
+			uint32_t b = (uint32_t)__builtin_ctzll(t);
+			if (b - prev - 1 >= k) return prev + k;
+			prev = b;
+		}
+		if (nb - 1 - hi >= k) return hi + k;
+	}
+	*gap = nb - 1 - hi;
+	return UINT32_MAX;
+}
 
-	volatile LONG64 best_m;     // global min found
-	volatile LONG64 end_limit;  // shrinks to best_m-1
+static void iota_u64_scalar(uint64_t* dst, uint64_t base, uint32_t n) {
+	for (uint32_t i = 0; i < n; ++i) dst[i] = base + (uint64_t)i;
+}
 
-	volatile LONG active_workers;
-	HANDLE evt_done;
-} Epoch;
+static void ones_to_bits_scalar(const uint64_t* residual, uint32_t n, uint8_t* bits) {
+	bitset_clear(bits, n);
+	for (uint32_t i = 0; i < n; ++i) {
+		if (residual[i] == 1) bitset_set(bits, i);
+	}
+}
 
-typedef struct JobSystem {
-	HANDLE iocp;
-	uint32_t thread_count;
-	Epoch epoch;
-} JobSystem;
+// floor(4 log2 x), +-1 after rounding x to a double
+static FORCEINLINE uint32_t lean_g(uint64_t x) {
+	double d = (double)x;
+	uint64_t b;
+	memcpy(&b, &d, sizeof(b));
+	uint64_t mt = b & ((1ull << 52) - 1);
+	return 4u * (uint32_t)((b >> 52) - 1023) + (mt >= LEAN_Q1) + (mt >= LEAN_Q2) + (mt >= LEAN_Q3);
+}
 
-typedef struct WorkerCtx {
-	JobSystem* js;
-	uint32_t tid;
-	HANDLE thread;
+// bit i set iff base_test + i is smooth by its lean word: with o the odd part (x itself
+// when tzm == 0, i.e. no 2 stripped), P == o mod 2^24 and L + LEAN_SLACK >= G(o).
+static void lean_to_bits_scalar(const uint32_t* lean, uint64_t base_test, uint32_t n, uint32_t tzm, uint8_t* bits) {
+	for (uint32_t i = 0; i < n; i += 8) {
+		uint32_t nb = (n - i < 8) ? n - i : 8;
+		uint32_t t = 0;
+		for (uint32_t j = 0; j < nb; ++j) {
+			uint64_t x = base_test + i + j;
+			uint32_t tz = (uint32_t)__builtin_ctzll(x) & tzm;
+			uint32_t w = lean[i + j];
+			t |= (uint32_t)(((w & LEAN_MASK) == (uint32_t)((x >> tz) & LEAN_MASK)) & ((w >> LEAN_BITS) + LEAN_SLACK + 4u * tz >= lean_g(x))) << j;
+		}
+		bits[i >> 3] = (uint8_t)t;
+	}
+}
 
-	uint64_t* residual;
-	uint8_t* bad_bits;
-	uint32_t  cap_win_len;
+// Feed bits[0..n) (the next n positions of the stream) into run. Returns the index of
+// the position where the run first reaches k clear bits, else UINT32_MAX.
+static uint32_t zero_run_feed_scalar(ZeroRun* run, const uint8_t* bits, uint32_t n, uint32_t k) {
+	for (uint32_t b = 0; b < n; b += 64) {
+		uint32_t nb = (n - b < 64) ? n - b : 64;
+		uint32_t r = zero_run_word(&run->gap, load_u64_bytes(bits + (b >> 3), (nb + 7) >> 3), nb, k);
+		if (r != UINT32_MAX) return b + r;
+	}
+	return UINT32_MAX;
+}
 
-	uint32_t* off;     // carried offsets, [prime_count]
-	uint32_t  off_cap;
-} WorkerCtx;
+#if defined(__clang__) || defined(__GNUC__)
 
-static FORCEINLINE uint64_t load_u64(volatile LONG64* p) {
-	return (uint64_t)InterlockedCompareExchange64((volatile LONG64*)p, 0, 0);
+// Chunked feed: an all-zero chunk only extends the gap, so one vector test skips it.
+#define ZERO_RUN_FEED_BODY(CHUNK_BITS, CHUNK_IS_ZERO)                                         \
+	uint32_t b = 0;                                                                          \
+	for (; b + CHUNK_BITS <= n; b += CHUNK_BITS) {                                           \
+		const uint8_t* c = bits + (b >> 3);                                                  \
+		if (CHUNK_IS_ZERO) {                                                                 \
+			if (run->gap + CHUNK_BITS >= k) return b + (uint32_t)(k - run->gap - 1);         \
+			run->gap += CHUNK_BITS;                                                          \
+			continue;                                                                        \
+		}                                                                                    \
+		for (uint32_t j = 0; j < CHUNK_BITS; j += 64) {                                      \
+			uint32_t r = zero_run_word(&run->gap, load_u64_bytes(c + (j >> 3), 8), 64, k);   \
+			if (r != UINT32_MAX) return b + j + r;                                           \
+		}                                                                                    \
+	}                                                                                        \
+	uint32_t r = zero_run_feed_scalar(run, bits + (b >> 3), n - b, k);                       \
+	return (r == UINT32_MAX) ? UINT32_MAX : b + r;
+
+TARGET("avx2") static void iota_u64_avx2(uint64_t* dst, uint64_t base, uint32_t n) {
+	__m256i v = _mm256_add_epi64(_mm256_set1_epi64x((long long)base), _mm256_setr_epi64x(0, 1, 2, 3));
+	const __m256i four = _mm256_set1_epi64x(4);
+	uint32_t i = 0;
+	for (; i + 4 <= n; i += 4) {
+		_mm256_storeu_si256((__m256i*)(dst + i), v);
+		v = _mm256_add_epi64(v, four);
+	}
+	for (; i < n; ++i) dst[i] = base + (uint64_t)i;
 }
 
-static FORCEINLINE void worker_epoch_done(JobSystem* js) {
-	if (InterlockedDecrement(&js->epoch.active_workers) == 0) {
-		SetEvent(js->epoch.evt_done);
+TARGET("avx2") static void ones_to_bits_avx2(const uint64_t* residual, uint32_t n, uint8_t* bits) {
+	const __m256i one = _mm256_set1_epi64x(1);
+	uint32_t i = 0;
+	for (; i + 8 <= n; i += 8) {
+		__m256i a = _mm256_cmpeq_epi64(_mm256_loadu_si256((const __m256i*)(residual + i)), one);
+		__m256i b = _mm256_cmpeq_epi64(_mm256_loadu_si256((const __m256i*)(residual + i + 4)), one);
+		int lo = _mm256_movemask_pd(_mm256_castsi256_pd(a));
+		int hi = _mm256_movemask_pd(_mm256_castsi256_pd(b));
+		bits[i >> 3] = (uint8_t)(lo | (hi << 4));
+	}
+	if (i < n) {
+		uint8_t t = 0;
+		for (uint32_t j = i; j < n; ++j) t |= (uint8_t)((residual[j] == 1) << (j - i));
+		bits[i >> 3] = t;
 	}
 }
 
-// Update best_m=min(best_m,m). If improved, shrink end_limit=min(end_limit, best_m-1).
-static FORCEINLINE void try_set_best(JobSystem* js, uint64_t m) {
-	for (;;) {
-		uint64_t cur = load_u64(&js->epoch.best_m);
-		if (m >= cur) return;
+// AVX2 has no 64-bit mullo: lo*lo + ((hi*lo + lo*hi) << 32)
+TARGET("avx2") static FORCEINLINE __m256i mullo_u64_avx2(__m256i a, __m256i b) {
+	__m256i lo = _mm256_mul_epu32(a, b);
+	__m256i cross = _mm256_add_epi64(_mm256_mul_epu32(_mm256_srli_epi64(a, 32), b),
+	                                 _mm256_mul_epu32(a, _mm256_srli_epi64(b, 32)));
+	return _mm256_add_epi64(lo, _mm256_slli_epi64(cross, 32));
+}
+
+TARGET("avx2") static void strip_small_avx2(uint64_t* residual, uint32_t nfull, const uint32_t* off, uint32_t p0, uint32_t ns) {
+	const __m256i sign = _mm256_set1_epi64x((long long)0x8000000000000000ull);
+	const __m256i lane_bit = _mm256_setr_epi64x(1, 2, 4, 8);
+	uint32_t ph[SIMD_SMALL_END];
+	for (uint32_t pi = p0; pi < ns; ++pi) ph[pi] = off[pi] ? g_small[pi].p - off[pi] : 0;
+
+	for (uint32_t v = 0; v < nfull; v += 4) {
+		__m256i x = _mm256_loadu_si256((const __m256i*)(residual + v));
+
+		for (uint32_t pi = p0; pi < ns; ++pi) {
+			const SimdSmallPrime* sp = &g_small[pi];
+			uint32_t m = sp->pat4[ph[pi]];
+			ph[pi] += sp->adv4;
+			if (ph[pi] >= sp->p) ph[pi] -= sp->p;
+			if (!m) continue;
+
+			__m256i inv = _mm256_set1_epi64x((long long)sp->inv);
+			__m256i lim = _mm256_xor_si256(_mm256_set1_epi64x((long long)sp->lim), sign);
+			__m256i vm = _mm256_and_si256(_mm256_set1_epi64x(m), lane_bit);
+			vm = _mm256_cmpeq_epi64(vm, lane_bit);
 
-		if (InterlockedCompareExchange64(&js->epoch.best_m, (LONG64)m, (LONG64)cur) == (LONG64)cur) {
-			uint64_t new_lim = (m == 0) ? 0 : (m - 1);
+			x = _mm256_blendv_epi8(x, mullo_u64_avx2(x, inv), vm);
 			for (;;) {
-				uint64_t old_lim = load_u64(&js->epoch.end_limit);
-				if (new_lim >= old_lim) break;
-				if (InterlockedCompareExchange64(&js->epoch.end_limit, (LONG64)new_lim, (LONG64)old_lim) == (LONG64)old_lim)
-					break;
+				__m256i z = mullo_u64_avx2(x, inv);
+				__m256i gt = _mm256_cmpgt_epi64(_mm256_xor_si256(z, sign), lim);
+				vm = _mm256_andnot_si256(gt, vm);
+				if (_mm256_testz_si256(vm, vm)) break;
+				x = _mm256_blendv_epi8(x, z, vm);
 			}
-			return;
 		}
+		_mm256_storeu_si256((__m256i*)(residual + v), x);
 	}
 }
 
-// ------------------------------------------------------------
-// Worker buffer management
-// ------------------------------------------------------------
-
-static void ensure_worker_buffers(WorkerCtx* w, uint32_t win_len) {
-	if (w->cap_win_len >= win_len) return;
-
-	if (w->residual) { VirtualFree(w->residual, 0, MEM_RELEASE); w->residual = NULL; }
-	if (w->bad_bits) { VirtualFree(w->bad_bits, 0, MEM_RELEASE); w->bad_bits = NULL; }
-
-	size_t residual_bytes = (size_t)win_len * sizeof(uint64_t);
-	size_t bad_bytes = (size_t)((win_len + 7u) >> 3);
-
-	w->residual = (uint64_t*)VirtualAlloc(NULL, residual_bytes, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE);
-	w->bad_bits = (uint8_t*)VirtualAlloc(NULL, bad_bytes, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE);
+TARGET("avx2") static uint32_t zero_run_feed_avx2(ZeroRun* run, const uint8_t* bits, uint32_t n, uint32_t k) {
+	ZERO_RUN_FEED_BODY(256, _mm256_testz_si256(_mm256_loadu_si256((const __m256i*)c), _mm256_loadu_si256((const __m256i*)c)))
+}
 
-	if (!w->residual || !w->bad_bits) {
-		fprintf(stderr, "VirtualAlloc failed for worker buffers (win_len=%u)\n", win_len);
-		ExitProcess(2);
+TARGET("avx512f,avx512dq") static void iota_u64_avx512(uint64_t* dst, uint64_t base, uint32_t n) {
+	__m512i v = _mm512_add_epi64(_mm512_set1_epi64((long long)base), _mm512_setr_epi64(0, 1, 2, 3, 4, 5, 6, 7));
+	const __m512i eight = _mm512_set1_epi64(8);
+	uint32_t i = 0;
+	for (; i + 8 <= n; i += 8) {
+		_mm512_storeu_si512((void*)(dst + i), v);
+		v = _mm512_add_epi64(v, eight);
 	}
-	w->cap_win_len = win_len;
+	for (; i < n; ++i) dst[i] = base + (uint64_t)i;
 }
 
-static void ensure_worker_off(WorkerCtx* w, uint32_t prime_count) {
-	if (prime_count == 0) {
-		if (w->off) { VirtualFree(w->off, 0, MEM_RELEASE); w->off = NULL; }
-		w->off_cap = 0;
-		return;
+TARGET("avx512f,avx512dq") static void ones_to_bits_avx512(const uint64_t* residual, uint32_t n, uint8_t* bits) {
+	const __m512i one = _mm512_set1_epi64(1);
+	uint32_t i = 0;
+	for (; i + 8 <= n; i += 8)
+		bits[i >> 3] = (uint8_t)_mm512_cmpeq_epi64_mask(_mm512_loadu_si512((const void*)(residual + i)), one);
+	if (i < n) {
+		__mmask8 live = (__mmask8)((1u << (n - i)) - 1u);
+		bits[i >> 3] = (uint8_t)_mm512_mask_cmpeq_epi64_mask(live, _mm512_maskz_loadu_epi64(live, residual + i), one);
 	}
-	if (w->off_cap >= prime_count) return;
+}
 
-	if (w->off) { VirtualFree(w->off, 0, MEM_RELEASE); w->off = NULL; }
+TARGET("avx512f,avx512dq") static void strip_small_avx512(uint64_t* residual, uint32_t nfull, const uint32_t* off, uint32_t p0, uint32_t ns) {
+	uint32_t ph[SIMD_SMALL_END];
+	for (uint32_t pi = p0; pi < ns; ++pi) ph[pi] = off[pi] ? g_small[pi].p - off[pi] : 0;
 
-	size_t bytes = (size_t)prime_count * sizeof(uint32_t);
-	w->off = (uint32_t*)VirtualAlloc(NULL, bytes, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE);
-	if (!w->off) {
-		fprintf(stderr, "VirtualAlloc failed for worker off[] (count=%u)\n", prime_count);
-		ExitProcess(2);
+	for (uint32_t v = 0; v < nfull; v += 8) {
+		__m512i x = _mm512_loadu_si512((const void*)(residual + v));
+
+		for (uint32_t pi = p0; pi < ns; ++pi) {
+			const SimdSmallPrime* sp = &g_small[pi];
+			__mmask8 m = sp->pat8[ph[pi]];
+			ph[pi] += sp->adv8;
+			if (ph[pi] >= sp->p) ph[pi] -= sp->p;
+			if (!m) continue;
+
+			__m512i inv = _mm512_set1_epi64((long long)sp->inv);
+			__m512i lim = _mm512_set1_epi64((long long)sp->lim);
+
+			x = _mm512_mask_mullo_epi64(x, m, x, inv);
+			for (;;) {
+				__m512i z = _mm512_mullo_epi64(x, inv);
+				m = _mm512_mask_cmple_epu64_mask(m, z, lim);
+				if (!m) break;
+				x = _mm512_mask_mov_epi64(x, m, z);
+			}
+		}
+		_mm512_storeu_si512((void*)(residual + v), x);
 	}
-	w->off_cap = prime_count;
 }
 
-// ------------------------------------------------------------
-// Precompute per-k epoch arrays: fd[] and step_mod[]
-// ------------------------------------------------------------
+TARGET("avx512f,avx512dq") static uint32_t zero_run_feed_avx512(ZeroRun* run, const uint8_t* bits, uint32_t n, uint32_t k) {
+	ZERO_RUN_FEED_BODY(512, _mm512_test_epi64_mask(_mm512_loadu_si512((const void*)c), _mm512_loadu_si512((const void*)c)) == 0)
+}
 
-static void epoch_free_math(Epoch* e) {
-	if (e->fd) { VirtualFree(e->fd, 0, MEM_RELEASE); e->fd = NULL; }
-	if (e->step_mod) { VirtualFree(e->step_mod, 0, MEM_RELEASE); e->step_mod = NULL; }
+// x as a double gives both G(x) and, from x & -x (a power of two, exact), ctz per lane.
+TARGET("avx512f,avx512dq") static void lean_to_bits_avx512(const uint32_t* lean, uint64_t base_test, uint32_t n, uint32_t tzm, uint8_t* bits) {
+	const __m512i mask = _mm512_set1_epi64(LEAN_MASK);
+	const __m512i mant = _mm512_set1_epi64((long long)((1ull << 52) - 1));
+	const __m512i q1 = _mm512_set1_epi64((long long)LEAN_Q1);
+	const __m512i q2 = _mm512_set1_epi64((long long)LEAN_Q2);
+	const __m512i q3 = _mm512_set1_epi64((long long)LEAN_Q3);
+	const __m512i bias = _mm512_set1_epi64(1023);
+	const __m512i tzmv = _mm512_set1_epi64(tzm);
+	const __m512i slack = _mm512_set1_epi64(LEAN_SLACK);
+	const __m512i one = _mm512_set1_epi64(1);
+	const __m512i eight = _mm512_set1_epi64(8);
+	__m512i x = _mm512_add_epi64(_mm512_set1_epi64((long long)base_test), _mm512_setr_epi64(0, 1, 2, 3, 4, 5, 6, 7));
+
+	for (uint32_t i = 0; i < n; i += 8) {
+		__mmask8 live = (n - i >= 8) ? (__mmask8)0xFF : (__mmask8)((1u << (n - i)) - 1u);
+		__m512i w = _mm512_cvtepu32_epi64(_mm512_castsi512_si256(_mm512_maskz_loadu_epi32((__mmask16)live, lean + i)));
+
+		__m512i low = _mm512_and_si512(x, _mm512_sub_epi64(_mm512_setzero_si512(), x));
+		__m512i tz = _mm512_sub_epi64(_mm512_srli_epi64(_mm512_castpd_si512(_mm512_cvtepu64_pd(low)), 52), bias);
+		tz = _mm512_and_si512(tz, tzmv);
+		__m512i o = _mm512_srlv_epi64(x, tz);
+
+		__m512i b = _mm512_castpd_si512(_mm512_cvtepu64_pd(x));
+		__m512i mt = _mm512_and_si512(b, mant);
+		__m512i g = _mm512_slli_epi64(_mm512_sub_epi64(_mm512_srli_epi64(b, 52), bias), 2);
+		g = _mm512_mask_add_epi64(g, _mm512_cmpge_epu64_mask(mt, q1), g, one);
+		g = _mm512_mask_add_epi64(g, _mm512_cmpge_epu64_mask(mt, q2), g, one);
+		g = _mm512_mask_add_epi64(g, _mm512_cmpge_epu64_mask(mt, q3), g, one);
+
+		__m512i lhs = _mm512_add_epi64(_mm512_add_epi64(_mm512_srli_epi64(w, LEAN_BITS), slack), _mm512_slli_epi64(tz, 2));
+		__mmask8 m = _mm512_mask_cmpeq_epi64_mask(live, _mm512_and_si512(w, mask), _mm512_and_si512(o, mask));
+		m = _mm512_mask_cmpge_epu64_mask(m, lhs, g);
+		bits[i >> 3] = (uint8_t)m;
+
+		x = _mm512_add_epi64(x, eight);
+	}
 }
 
-static void epoch_prepare_math(JobSystem* js) {
-	Epoch* e = &js->epoch;
-	uint32_t n = e->primes.count;
+static uint32_t cpu_simd_level(void) {
+	unsigned a, b, c, d;
+	if (__get_cpuid_max(0, NULL) < 7) return SIMD_SCALAR;
 
-	epoch_free_math(e);
+	__cpuid_count(1, 0, a, b, c, d);
+	if (!(c & (1u << 27)) || !(c & (1u << 28))) return SIMD_SCALAR;    // OSXSAVE, AVX
 
-	if (n == 0) {
-		e->fd = NULL;
-		e->step_mod = NULL;
-		return;
-	}
+	uint32_t xlo, xhi;
+	__asm__ volatile("xgetbv" : "=a"(xlo), "=d"(xhi) : "c"(0));
+	if ((xlo & 0x6u) != 0x6u) return SIMD_SCALAR;                       // OS saves XMM+YMM
 
-	size_t fd_bytes = (size_t)n * sizeof(FastDivU32);
-	size_t sm_bytes = (size_t)n * sizeof(uint32_t);
+	__cpuid_count(7, 0, a, b, c, d);
+	if (!(b & (1u << 5))) return SIMD_SCALAR;                           // AVX2
+	if ((b & (1u << 16)) && (b & (1u << 17)) && (xlo & 0xE0u) == 0xE0u) // AVX512F+DQ, opmask+ZMM
+		return SIMD_AVX512;
+	return SIMD_AVX2;
+}
 
-	e->fd = (FastDivU32*)VirtualAlloc(NULL, fd_bytes, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE);
-	e->step_mod = (uint32_t*)VirtualAlloc(NULL, sm_bytes, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE);
-	if (!e->fd || !e->step_mod) {
-		fprintf(stderr, "VirtualAlloc failed for epoch fd/step_mod (count=%u)\n", n);
-		ExitProcess(2);
-	}
+#else
+static uint32_t cpu_simd_level(void) { return SIMD_SCALAR; }
+#endif
 
-	for (uint32_t i = 0; i < n; ++i) {
-		uint32_t p = e->primes.p[i];
-		e->fd[i] = fastdiv_u32_make_prime(p);
+static void simd_init(uint32_t max_level, int small_stage) {
+	static const uint32_t small[SIMD_SMALL_END] = { 2, 3, 5, 7, 11, 13, 17, 19, 23, 29, 31, 37, 41, 43, 47, 53, 59, 61 };
+
+	for (uint32_t pi = 1; pi < SIMD_SMALL_END; ++pi) {
+		SimdSmallPrime* sp = &g_small[pi];
+		uint32_t p = small[pi];
+		sp->p = p;
+		sp->adv4 = 4 % p;
+		sp->adv8 = 8 % p;
+		sp->inv = inverse_u64(p);
+		sp->lim = UINT64_MAX / p;
+		for (uint32_t r = 0; r < p; ++r) {
+			uint8_t m4 = 0, m8 = 0;
+			for (uint32_t j = 0; j < 8; ++j) {
+				if ((r + j) % p) continue;
+				if (j < 4) m4 |= (uint8_t)(1u << j);
+				m8 |= (uint8_t)(1u << j);
+			}
+			sp->pat4[r] = m4;
+			sp->pat8[r] = m8;
+		}
 	}
 
-	for (uint32_t i = 0; i < n; ++i) {
-		uint32_t p = e->primes.p[i];
-		if (p == 2) e->step_mod[i] = (uint32_t)(e->step & 1ull);
-		else        e->step_mod[i] = fastdiv_u32_mod(&e->fd[i], e->step);
+	uint32_t level = cpu_simd_level();
+	if (level > max_level) level = max_level;
+
+	SimdOps ops = { "scalar", 1, iota_u64_scalar, ones_to_bits_scalar, NULL, zero_run_feed_scalar, lean_to_bits_scalar };
+#if defined(__clang__) || defined(__GNUC__)
+	if (level == SIMD_AVX2) {
+		SimdOps v = { "avx2", 4, iota_u64_avx2, ones_to_bits_avx2, strip_small_avx2, zero_run_feed_avx2, lean_to_bits_scalar };
+		ops = v;
 	}
+	if (level == SIMD_AVX512) {
+		SimdOps v = { "avx512", 8, iota_u64_avx512, ones_to_bits_avx512, strip_small_avx512, zero_run_feed_avx512, lean_to_bits_avx512 };
+		ops = v;
+	}
+#endif
+	if (!small_stage) ops.strip_small = NULL;
+	g_simd = ops;
 }
 
 // ------------------------------------------------------------
-// Sieve (carried offsets + FastDiv in factor stripping)
+// Wheel pre-sieve (2, 3, 5, 7, 11, 13)
 // ------------------------------------------------------------
 //
-// base_test = m0 + 1
-// off[pi]   = smallest i>=0 such that (base_test + i) % p == 0, carried across tiles
+// Which of 3..13 divide v depends only on v % 15015, so the residual starts as
+// (v >> ctz v) * d^-1 mod 2^64 with d the product of those primes: exact division, one
+// multiply per value. Values with p^2 | v still hold a factor p; they are met by p^2
+// strides. Only used when all six primes are <= k and stripped directly.
 //
 
-static void sieve_window_bad_bits_carried_fastdiv(
-	const Epoch* e,
-	uint64_t base_test,
-	uint32_t start_count,
-	uint32_t* off,          // in/out [prime_count]
-	uint64_t* residual,     // [win_len]
-	uint8_t* bad_bits      // bitset [win_len]
-) {
-	uint32_t k = e->k;
-	uint32_t win_len = start_count + k;
+#define WHEEL_PRIMES 6          // primes[0..6) = 2..13
+#define WHEEL_MOD    15015u     // 3*5*7*11*13
 
-	for (uint32_t i = 0; i < win_len; ++i) residual[i] = base_test + (uint64_t)i;
-	bitset_clear(bad_bits, win_len);
+typedef struct Wheel {
+	uint8_t  set[WHEEL_MOD];    // [v % 15015] bit j: wheel_odd[j] | v
+	uint64_t inv[32];           // [set] d^-1 mod 2^64
+	uint32_t top[32];           // [set] largest prime in d (0 for d == 1)
+} Wheel;
 
-	uint32_t pc = e->primes.count;
-	const uint32_t* primes = e->primes.p;
-	const FastDivU32* fd = e->fd;
-	const uint32_t* step_mod = e->step_mod;
+static const uint32_t wheel_odd[WHEEL_PRIMES - 1] = { 3, 5, 7, 11, 13 };
+static Wheel g_wheel;
 
-	for (uint32_t pi = 0; pi < pc; ++pi) {
-		uint32_t p = primes[pi];
+static void wheel_init(void) {
+	for (uint32_t m = 0; m < 32; ++m) {
+		uint64_t d = 1;
+		uint32_t top = 0;
+		for (uint32_t j = 0; j < WHEEL_PRIMES - 1; ++j) {
+			if (m & (1u << j)) { d *= wheel_odd[j]; top = wheel_odd[j]; }
+		}
+		g_wheel.inv[m] = inverse_u64(d);
+		g_wheel.top[m] = top;
+	}
+	for (uint32_t r = 0; r < WHEEL_MOD; ++r) {
+		uint8_t m = 0;
+		for (uint32_t j = 0; j < WHEEL_PRIMES - 1; ++j) {
+			if (r % wheel_odd[j] == 0) m |= (uint8_t)(1u << j);
+		}
+		g_wheel.set[r] = m;
+	}
+}
 
-		// process multiples inside this window
-		for (uint32_t i = off[pi]; i < win_len; i += p) {
-			uint64_t x = residual[i];
+// residual[i] = (base_test + i) with every 2 and one of each odd wheel prime divided out;
+// with lpf, lpf[i] = largest wheel prime of the value (0 if none).
+static void wheel_fill(uint64_t* residual, uint32_t* lpf, uint64_t base_test, uint32_t n) {
+	uint32_t r = (uint32_t)(base_test % WHEEL_MOD);
+	uint32_t i = 0;
 
-			if (p == 2) {
-				// x is even here (by construction)
-				x >>= (uint64_t)__builtin_ctzll(x);
+	while (i < n) {
+		uint32_t run = WHEEL_MOD - r;
+		if (run > n - i) run = n - i;
+		const uint8_t* set = &g_wheel.set[r];
+
+		for (uint32_t j = 0; j < run; ++j) {
+			uint64_t v = base_test + i + j;
+			uint32_t m = set[j];
+			residual[i + j] = (v >> __builtin_ctzll(v)) * g_wheel.inv[m];
+			if (lpf) {
+				uint32_t t = g_wheel.top[m];
+				lpf[i + j] = (t || (v & 1)) ? t : 2u;
 			}
-			else {
-				const FastDivU32* f = &fd[pi];
-				while (fastdiv_u32_divide_if_divisible(f, &x)) { /* repeat */ }
-			}
-			residual[i] = x;
 		}
+		i += run;
+		r = 0;
+	}
+}
 
-		// carry offset to next tile in this worker stream:
-		// base_test' = base_test + step, so off' = off - (step % p) mod p
-		uint32_t sm = step_mod[pi];
-		if (sm) {
+// ------------------------------------------------------------
+// Epoch system (jobs posted through JobQueue)
+// ------------------------------------------------------------
+
+enum { KEY_STOP = 1, KEY_START = 2 };   // KEY_START + epoch slot
+
+#define EPOCH_DEPTH 2   // batches in flight
+
+enum { EPOCH_FIND_M = 0, EPOCH_SWEEP = 1, EPOCH_VERIFY = 2, EPOCH_TASK = 3 };
+
+// EPOCH_TASK: a lane of a program that includes this file (MK_NO_MAIN) and brings its own jobs.
+struct WorkerCtx;
+typedef void (*EpochTaskFn)(struct WorkerCtx* w, void* arg, uint32_t lane);
+
+enum { SCHED_STRIDED = 0, SCHED_CONTIG = 1, SCHED_STEAL = 2 };
+
+enum { KERNEL_EXACT = 0, KERNEL_LOG = 1, KERNEL_LEAN = 2 };
+
+// Sweep output: K-smooth values of one tile, in increasing order.
+typedef struct SmoothHit {
+	uint32_t i;     // offset in tile (value = base_test + i)
+	uint32_t q;     // largest prime factor (1 for the value 1)
+} SmoothHit;
+
+typedef struct SweepTile {
+	SmoothHit* hit;
+	uint32_t   count;
+	uint32_t   cap;
+} SweepTile;
+
+// SCHED_CONTIG find lanes: how the lane's values begin and end, so the main thread can
+// stitch runs that cross lane (and epoch) boundaries without any value being re-sieved.
+typedef struct LaneRun {
+	uint64_t head;      // clear values from the lane's first value (== len when all clear)
+	uint64_t tail;      // clear values ending at the last value sieved
+	uint64_t len;       // values sieved
+	uint32_t complete;  // sieved through its last value without a run of its own
+} LaneRun;
+
+// EPOCH_VERIFY: one (k, m) row of a plateau file and what its window says.
+typedef struct VerifyRow {
+	uint64_t m;
+	uint32_t k;
+	uint32_t next_k;    // k of the following row, 0 for the last
+	uint32_t win;       // first window: values m+1 .. m+win (doubled while the run lasts)
+	uint32_t len;       // true plateau length: largest z with P(m+i) > z for all i <= z
+	uint32_t bad;       // len < k: first offset i <= k with m+i k-smooth
+	uint32_t open;      // still to sieve (after a pass: the run reached the prime bound)
+} VerifyRow;
+
+// One batch of tiles [start_m, end_m] and the lanes working on it.
+typedef struct EpochSlot {
+	uint64_t  start_m;      // inclusive
+	uint64_t  end_m;        // inclusive
+	uint64_t  lane_span;    // SCHED_CONTIG: starts per lane (multiple of tile_len)
+	uint32_t  tile_count;   // tiles in the batch
+	uint32_t  busy;         // main thread only: begun and not yet waited for
+
+	shared_u32 active_workers;
+	SysEvent evt_done;
+
+	SweepTile* sweep_tiles; // EPOCH_SWEEP: one entry per tile of the batch
+	LaneRun*  lane_runs;    // SCHED_CONTIG find: [thread_count]
+	shared_u64* steal;      // SCHED_STEAL: [thread_count] tile range of each lane, hi << 32 | lo
+	VerifyRow* verify_rows; // EPOCH_VERIFY: every row of the file, strided over the lanes
+	uint32_t  verify_count;
+} EpochSlot;
+
+// Per-k read-only tables as one worker sees them: its node's replica, or the Epoch's own
+// arrays on a single node.
+typedef struct EpochTables {
+	const uint32_t*    primes;    // [prime_count]
+	const FastDivU32*  fd;        // [prime_count]
+	const ExactDivU64* inv;       // [prime_count]
+	const uint32_t*    step_mod;  // [prime_count]
+	const ExactDivU128* inv128;   // [prime_count] once origin != 0 (shared, not replicated)
+} EpochTables;
+
+typedef struct Epoch {
+	uint32_t  mode;         // EPOCH_FIND_M / EPOCH_SWEEP / EPOCH_VERIFY / EPOCH_TASK
+	EpochTaskFn task;       // EPOCH_TASK: run once per lane with task_arg
+	void*     task_arg;
+	uint32_t  schedule;     // SCHED_STRIDED / SCHED_CONTIG / SCHED_STEAL
+	uint32_t  bucket;       // bucket sieve enabled (SCHED_CONTIG only)
+	uint32_t  kernel;       // KERNEL_EXACT / KERNEL_LOG / KERNEL_LEAN
+	uint32_t  k;            // EPOCH_SWEEP, EPOCH_VERIFY: prime bound
+	uint32_t  tile_len;
+	uint64_t  step;         // distance between consecutive tiles of one lane:
+	                        // tile_len * thread_count (strided), tile_len (contig, steal)
+	uint32_t  math_gen;     // bumped when off[] must be re-derived; tags WorkerCtx.off
+	uint32_t  math_log;     // the last epoch_prepare_math was for KERNEL_LOG (off[] by power)
+	u128      origin;       // find mode: m = origin + the u64 positions below (0 until rebased)
+
+	PrimeList primes;       // this k: a prefix of prime_cache (not owned)
+
+	// Prime tables for every prime <= cache_k, built once and grown on demand; a k uses the
+	// first primes.count entries. step_mod follows step (tile_len or thread count changes).
+	PrimeList prime_cache;
+	uint32_t  cache_k;
+	uint32_t  cap_k;        // largest k the run will ask for, if known (0: grow by doubling)
+	uint64_t  cache_step;   // step that step_mod[] holds
+	FastDivU32* fd;         // [cache count]
+	ExactDivU64* inv;       // [cache count]  divisibility tests and exact quotients, odd p
+	uint32_t* step_mod;   // [cache count]  (step % p)
+	ExactDivU128* inv128;   // [cache count]  wide kernel, built on the first k with origin != 0
+
+	uint32_t  node_count;   // NUMA nodes with workers (1: no replicas)
+	EpochTables tab[SYS_MAX_NODES];
+	void*     tab_mem[SYS_MAX_NODES];   // replica blocks (node_count > 1)
+
+	uint32_t  bucket_first; // primes[bucket_first..] go through the bucket ring (== count if off)
+	uint32_t  wheel;        // primes[0..WHEEL_PRIMES) come from the wheel pre-sieve
+	uint32_t  bucket_win;   // full window length the bucket primes were chosen for
+
+	// KERNEL_LOG: every prime power q = p^e < 2^32; the largest one per p comes last
+	// (from pow_top_first) and forces a candidate, since higher powers are not tracked.
+	uint32_t* pow_q;        // [pow_count]
+	uint32_t* pow_p;        // [pow_count]
+	uint32_t* pow_step_mod; // [pow_count]  (step % q)
+	uint8_t*  pow_log;      // [pow_count]  ceil(log_scale * log2 p), added per hit
+	uint32_t  pow_count;
+	uint32_t  pow_top_first;
+	uint32_t  log_scale;    // log units per bit, chosen so sums fit a byte up to end_m
+
+	// Shared by every slot in flight: a find in a later batch shrinks end_limit too,
+	// but is only returned once all earlier batches are done.
+	shared_u64 best_m;      // global min found
+	shared_u64 end_limit;   // shrinks to best_m-1
+
+	uint32_t   sweep_tile_count;  // EPOCH_SWEEP: tiles per batch
+	uint64_t   carry_gap;   // SCHED_CONTIG: clear values ending at the next batch to stitch
+
+	EpochSlot  slot[EPOCH_DEPTH];
+} Epoch;
+
+// ------------------------------------------------------------
+// Bucket ring for large primes (Oliveira e Silva style)
+// ------------------------------------------------------------
+//
+// A prime p >= window length hits a window at most once, so it sits in exactly one
+// bucket: the one of the next tile of this lane that it lands in. Tiles only touch the
+// bucket hits they own, and no off[] carry is needed for those primes.
+//
+
+typedef struct BucketHit {
+	uint32_t pi;        // prime index
+	uint32_t i;         // offset in the owning tile's window
+} BucketHit;
+
+typedef struct BucketRing {
+	BucketHit* hit;     // [nb * per], bucket b is hit[b*per .. b*per + count[b])
+	uint32_t*  count;   // [nb]
+	uint32_t   nb;      // ring size: max tiles a prime can skip + 2
+	uint32_t   per;     // capacity per bucket (large prime count)
+	uint32_t   cur;     // bucket of the lane's current tile
+	size_t     cap;     // allocated hit entries
+	uint32_t   cap_nb;
+} BucketRing;
+
+// ------------------------------------------------------------
+// Run statistics (--stats)
+// ------------------------------------------------------------
+//
+// Each worker counts into its own WorkerCtx.stat[] and stores the row to Stats.pub at the
+// end of every job, before it signs off the batch; the main thread reads the rows after
+// epoch_wait. Prime hits (multiples of the sieving primes in the values sieved) and
+// FastDiv corrections are only counted with STATS_HOT.
+//
+
+enum { STAT_TILES, STAT_VALUES, STAT_HITS, STAT_FD_FIX, STAT_BUSY_US, STAT_IDLE_US, STAT_COUNT };
+
+typedef struct StatMark {
+	uint64_t  us;         // sys_now_us() when taken
+	uint64_t  wait_us;    // Stats.wait_us then
+	uint64_t* row;        // [thread_count * STAT_COUNT]
+} StatMark;
+
+typedef struct Stats {
+	shared_u64* pub;      // [thread_count * STAT_COUNT], row tid stored by worker tid only
+	uint64_t  wait_us;    // main thread blocked in epoch_wait
+	int       on;
+	int       json;       // one JSON object per line instead of "; ..." text
+	uint32_t  every_ms;   // heartbeat interval, 0: per-k and final lines only
+	StatMark  beat, k, run;   // last heartbeat, start of the current k, start of the run
+	uint64_t* cur;        // [thread_count * STAT_COUNT] scratch for a report
+} Stats;
+
+enum { ECORES_LAST = 0, ECORES_OFF = 1, ECORES_ONLY = 2 };
+
+// Worker placement for start_workers (--smt, --ecores, --priority) and what it found.
+typedef struct Placement {
+	uint32_t smt;       // thread_count 0 takes every logical CPU, not one per core
+	uint32_t ecores;    // ECORES_*: slower efficiency classes after the rest, left out, or alone
+	uint32_t priority;  // PRIORITY_*
+	uint32_t cores;     // out: physical cores placed on
+	uint32_t l2;        // out: smallest L2 share of one worker in bytes (0: not reported)
+} Placement;
+
+typedef struct JobSystem {
+	JobQueue jobs;
+	uint32_t thread_count;
+	Placement place;
+	Epoch epoch;
+	Stats stats;
+} JobSystem;
+
+typedef struct WorkerCtx {
+	JobSystem* js;
+	uint32_t tid;
+	uint32_t node;     // NUMA node of the worker's CPU (< SYS_MAX_NODES)
+	SysThread thread;
+
+	uint64_t* residual;
+	uint8_t* bad_bits;
+	uint32_t  cap_win_len;
+
+	uint32_t* off;     // carried offsets, [prime_count]
+	uint32_t  off_cap;
+	uint32_t  off_gen; // Epoch.math_gen that off[] belongs to
+	uint64_t  off_next;// base_test that off[] is positioned for
+	uint32_t  off_count;// leading primes whose off[] is positioned (not KERNEL_LOG)
+
+	uint32_t* lpf;     // EPOCH_SWEEP: largest stripped prime, [win_len]
+	uint32_t  cap_lpf_len;
+
+	uint8_t*  logs;    // KERNEL_LOG: scaled log2 of the smooth part, [win_len]
+	uint32_t  cap_logs_len;
+
+	uint32_t* lean;    // KERNEL_LEAN: packed odd smooth part, [win_len]
+	uint32_t  cap_lean_len;
+
+	u128*     wide;    // Epoch.origin != 0: u128 residual, [win_len]
+	uint32_t  cap_wide_len;
+
+	BucketRing br;     // Epoch.bucket: large primes of the current lane
+
+	uint64_t stat[STAT_COUNT];   // published to JobSystem.stats.pub per job
+} WorkerCtx;
+
+static FORCEINLINE void worker_epoch_done(EpochSlot* es) {
+	if (dec_u32(&es->active_workers) == 0) {
+		event_set(&es->evt_done);
+	}
+}
+
+// end_limit = min(end_limit, new_lim)
+static FORCEINLINE void lower_end_limit(JobSystem* js, uint64_t new_lim) {
+	for (;;) {
+		uint64_t old_lim = load_u64(&js->epoch.end_limit);
+		if (new_lim >= old_lim) break;
+		if (cas_u64(&js->epoch.end_limit, old_lim, new_lim)) break;
+	}
+}
+
+// Update best_m=min(best_m,m). If improved, shrink end_limit=min(end_limit, best_m-1).
+static FORCEINLINE void try_set_best(JobSystem* js, uint64_t m) {
+	for (;;) {
+		uint64_t cur = load_u64(&js->epoch.best_m);
+		if (m >= cur) return;
+
+		if (cas_u64(&js->epoch.best_m, cur, m)) {
+			lower_end_limit(js, (m == 0) ? 0 : (m - 1));
+			return;
+		}
+	}
+}
+
+// ------------------------------------------------------------
+// Worker buffer management
+// ------------------------------------------------------------
+
+static void ensure_worker_buffers(WorkerCtx* w, uint32_t win_len) {
+	if (w->cap_win_len >= win_len) return;
+
+	if (w->residual) { sys_free(w->residual); w->residual = NULL; }
+	if (w->bad_bits) { sys_free(w->bad_bits); w->bad_bits = NULL; }
+
+	size_t residual_bytes = (size_t)win_len * sizeof(uint64_t);
+	size_t bad_bytes = (size_t)((win_len + 7u) >> 3);
+
+	w->residual = (uint64_t*)sys_alloc_node(residual_bytes, w->node);
+	w->bad_bits = (uint8_t*)sys_alloc_node(bad_bytes, w->node);
+
+	if (!w->residual || !w->bad_bits) {
+		fprintf(stderr, "alloc failed for worker buffers (win_len=%u)\n", win_len);
+		exit(2);
+	}
+	w->cap_win_len = win_len;
+}
+
+static void ensure_worker_lpf(WorkerCtx* w, uint32_t win_len) {
+	if (w->cap_lpf_len >= win_len) return;
+
+	if (w->lpf) { sys_free(w->lpf); w->lpf = NULL; }
+
+	w->lpf = (uint32_t*)sys_alloc_node((size_t)win_len * sizeof(uint32_t), w->node);
+	if (!w->lpf) {
+		fprintf(stderr, "alloc failed for worker lpf[] (win_len=%u)\n", win_len);
+		exit(2);
+	}
+	w->cap_lpf_len = win_len;
+}
+
+static void ensure_worker_logs(WorkerCtx* w, uint32_t win_len) {
+	if (w->cap_logs_len >= win_len) return;
+
+	if (w->logs) { sys_free(w->logs); w->logs = NULL; }
+
+	w->logs = (uint8_t*)sys_alloc_node((size_t)win_len, w->node);
+	if (!w->logs) {
+		fprintf(stderr, "alloc failed for worker logs[] (win_len=%u)\n", win_len);
+		exit(2);
+	}
+	w->cap_logs_len = win_len;
+}
+
+static void ensure_worker_lean(WorkerCtx* w, uint32_t win_len) {
+	if (w->cap_lean_len >= win_len) return;
+
+	if (w->lean) { sys_free(w->lean); w->lean = NULL; }
+
+	w->lean = (uint32_t*)sys_alloc_node((size_t)win_len * sizeof(uint32_t), w->node);
+	if (!w->lean) {
+		fprintf(stderr, "alloc failed for worker lean[] (win_len=%u)\n", win_len);
+		exit(2);
+	}
+	w->cap_lean_len = win_len;
+}
+
+static void ensure_worker_wide(WorkerCtx* w, uint32_t win_len) {
+	if (w->cap_wide_len >= win_len) return;
+
+	if (w->wide) { sys_free(w->wide); w->wide = NULL; }
+
+	w->wide = (u128*)sys_alloc_node((size_t)win_len * sizeof(u128), w->node);
+	if (!w->wide) {
+		fprintf(stderr, "alloc failed for worker wide[] (win_len=%u)\n", win_len);
+		exit(2);
+	}
+	w->cap_wide_len = win_len;
+}
+
+// Find windows: bad_bits plus whatever the kernel sieves into (the u64 residual is only
+// touched by KERNEL_EXACT).
+static void ensure_worker_find(WorkerCtx* w, const Epoch* e, uint32_t win_len) {
+	ensure_worker_buffers(w, win_len);
+	if      (e->origin)                ensure_worker_wide(w, win_len);
+	else if (e->kernel == KERNEL_LOG)  ensure_worker_logs(w, win_len);
+	else if (e->kernel == KERNEL_LEAN) ensure_worker_lean(w, win_len);
+}
+
+static void ensure_worker_off(WorkerCtx* w, uint32_t prime_count) {
+	if (prime_count == 0) {
+		if (w->off) { sys_free(w->off); w->off = NULL; }
+		w->off_cap = 0;
+		return;
+	}
+	if (w->off_cap >= prime_count) return;
+
+	// keeps the entries so far: a larger k extends off[] in place
+	size_t bytes = (size_t)prime_count * sizeof(uint32_t);
+	uint32_t* off = (uint32_t*)sys_alloc_node(bytes, w->node);
+	if (!off) {
+		fprintf(stderr, "alloc failed for worker off[] (count=%u)\n", prime_count);
+		exit(2);
+	}
+	if (w->off) {
+		memcpy(off, w->off, (size_t)w->off_cap * sizeof(uint32_t));
+		sys_free(w->off);
+	}
+	w->off = off;
+	w->off_cap = prime_count;
+}
+
+static void ensure_worker_buckets(WorkerCtx* w, uint32_t nb, uint32_t per) {
+	BucketRing* br = &w->br;
+	size_t need = (size_t)nb * per;
+
+	if (br->cap < need) {
+		if (br->hit) sys_free(br->hit);
+		br->hit = (BucketHit*)sys_alloc_node(need * sizeof(BucketHit), w->node);
+		if (!br->hit) {
+			fprintf(stderr, "alloc failed for worker buckets (nb=%u, per=%u)\n", nb, per);
+			exit(2);
+		}
+		br->cap = need;
+	}
+	if (br->cap_nb < nb) {
+		free(br->count);
+		br->count = (uint32_t*)malloc((size_t)nb * sizeof(uint32_t));
+		if (!br->count) {
+			fprintf(stderr, "malloc failed for worker bucket counts (nb=%u)\n", nb);
+			exit(2);
+		}
+		br->cap_nb = nb;
+	}
+	memset(br->count, 0, (size_t)nb * sizeof(uint32_t));
+	br->nb = nb;
+	br->per = per;
+	br->cur = 0;
+}
+
+// ------------------------------------------------------------
+// Precompute per-k epoch arrays: fd[], inv[] and step_mod[]
+// ------------------------------------------------------------
+
+static void epoch_free_replicas(Epoch* e) {
+	for (uint32_t i = 0; i < SYS_MAX_NODES; ++i) {
+		sys_free(e->tab_mem[i]);
+		e->tab_mem[i] = NULL;
+	}
+	memset(e->tab, 0, sizeof(e->tab));
+}
+
+// The prime cache and its tables (at exit, or before growing them).
+static void epoch_free_tables(Epoch* e) {
+	if (e->fd) { sys_free(e->fd); e->fd = NULL; }
+	if (e->inv) { sys_free(e->inv); e->inv = NULL; }
+	if (e->step_mod) { sys_free(e->step_mod); e->step_mod = NULL; }
+	if (e->inv128) { sys_free(e->inv128); e->inv128 = NULL; }
+	epoch_free_replicas(e);
+	primes_free(&e->prime_cache);
+	e->primes.p = NULL;
+	e->primes.count = 0;
+	e->cache_k = 0;
+	e->cache_step = 0;
+}
+
+// Per-k state only; the cached prime tables stay for the next k.
+static void epoch_free_math(Epoch* e) {
+	free(e->pow_q); free(e->pow_p); free(e->pow_step_mod); free(e->pow_log);
+	e->pow_q = e->pow_p = e->pow_step_mod = NULL;
+	e->pow_log = NULL;
+	e->pow_count = e->pow_top_first = 0;
+	e->log_scale = 0;
+}
+
+// KERNEL_LOG: list p^e < 2^32 for all primes, non-top powers first, then the top power of each p.
+static void epoch_prepare_log_powers(Epoch* e) {
+	uint32_t n = e->primes.count;
+	uint32_t count = 0;
+
+	for (uint32_t i = 0; i < n; ++i)
+		for (uint64_t q = e->primes.p[i]; q <= UINT32_MAX; q *= e->primes.p[i]) ++count;
+
+	e->pow_q = (uint32_t*)malloc((size_t)count * sizeof(uint32_t));
+	e->pow_p = (uint32_t*)malloc((size_t)count * sizeof(uint32_t));
+	e->pow_step_mod = (uint32_t*)malloc((size_t)count * sizeof(uint32_t));
+	e->pow_log = (uint8_t*)malloc((size_t)count);
+	if (!e->pow_q || !e->pow_p || !e->pow_step_mod || !e->pow_log) {
+		fprintf(stderr, "malloc failed for log kernel powers (count=%u)\n", count);
+		exit(2);
+	}
+
+	uint32_t w = 0;
+	for (uint32_t pass = 0; pass < 2; ++pass) {
+		if (pass == 1) e->pow_top_first = w;
+		for (uint32_t i = 0; i < n; ++i) {
+			uint32_t p = e->primes.p[i];
+			for (uint64_t q = p; q <= UINT32_MAX; q *= p) {
+				int top = (q * p > UINT32_MAX);
+				if (top != (int)pass) continue;
+				e->pow_q[w] = (uint32_t)q;
+				e->pow_p[w] = p;
+				e->pow_step_mod[w] = (uint32_t)(e->step % q);
+				++w;
+			}
+		}
+	}
+	e->pow_count = w;
+	e->log_scale = 0;
+}
+
+// KERNEL_LOG: pick the scale for values up to x_hi. A smooth x accumulates at most
+// scale*log2(x) + Omega(x) <= (scale+1)*log2(x) units (each hit is rounded up), so
+// (scale+1)*log2(x_hi) must stay below one byte.
+static uint32_t log_scale_for(uint64_t x_hi) {
+	double bits = log2((double)x_hi);
+	if (bits < 1.0) bits = 1.0;
+
+	int scale = (int)(254.0 / bits) - 1;
+	return (scale < 1) ? 1u : (uint32_t)scale;
+}
+
+static void epoch_update_log_scale(Epoch* e, uint64_t x_hi) {
+	uint32_t scale = log_scale_for(x_hi);
+	if (scale == e->log_scale) return;
+
+	e->log_scale = scale;
+	for (uint32_t i = 0; i < e->pow_count; ++i) {
+		uint32_t p = e->pow_p[i];
+		// round up (with margin): undercounting a smooth value could hide it
+		e->pow_log[i] = (p == 2) ? (uint8_t)scale : (uint8_t)ceil(scale * log2((double)p) + 1e-9);
+	}
+}
+
+// One block per node holding fd, inv, primes and step_mod, bound to that node before the copy.
+static void epoch_replicate_tables(Epoch* e) {
+	uint32_t n = e->prime_cache.count;
+	EpochTables own = { e->prime_cache.p, e->fd, e->inv, e->step_mod, e->inv128 };
+	epoch_free_replicas(e);
+	for (uint32_t i = 0; i < SYS_MAX_NODES; ++i) e->tab[i] = own;
+	if (e->node_count <= 1 || n == 0) return;
+
+	size_t fd_bytes = (size_t)n * sizeof(FastDivU32);
+	size_t inv_bytes = (size_t)n * sizeof(ExactDivU64);
+	size_t u32_bytes = (size_t)n * sizeof(uint32_t);
+	for (uint32_t node = 0; node < e->node_count; ++node) {
+		uint8_t* b = (uint8_t*)sys_alloc_node(fd_bytes + inv_bytes + 2 * u32_bytes, node);
+		if (!b) {
+			fprintf(stderr, "alloc failed for node %u tables (count=%u)\n", node, n);
+			exit(2);
+		}
+		uint8_t* u = b + fd_bytes + inv_bytes;
+		memcpy(b, e->fd, fd_bytes);
+		memcpy(b + fd_bytes, e->inv, inv_bytes);
+		memcpy(u, e->prime_cache.p, u32_bytes);
+		memcpy(u + u32_bytes, e->step_mod, u32_bytes);
+
+		e->tab_mem[node] = b;
+		e->tab[node].fd = (const FastDivU32*)b;
+		e->tab[node].inv = (const ExactDivU64*)(b + fd_bytes);
+		e->tab[node].primes = (const uint32_t*)u;
+		e->tab[node].step_mod = (const uint32_t*)(u + u32_bytes);
+		e->tab[node].inv128 = e->inv128;
+	}
+}
+
+// Inverses mod 2^128 for the whole prime cache, once the search has been rebased.
+static void epoch_build_wide(Epoch* e) {
+	uint32_t n = e->prime_cache.count;
+	e->inv128 = (ExactDivU128*)sys_alloc((size_t)(n ? n : 1) * sizeof(ExactDivU128));
+	if (!e->inv128) {
+		fprintf(stderr, "alloc failed for wide tables (count=%u)\n", n);
+		exit(2);
+	}
+	for (uint32_t i = 0; i < n; ++i) e->inv128[i] = exactdiv128_make(e->prime_cache.p[i]);
+	for (uint32_t i = 0; i < SYS_MAX_NODES; ++i) e->tab[i].inv128 = e->inv128;
+}
+
+// Grow the prime cache to cover primes <= k (to cap_k at once when it is known).
+static void epoch_grow_tables(Epoch* e, uint32_t k) {
+	uint32_t want = (e->cap_k > k) ? e->cap_k : k;
+	if (e->cache_k && e->cache_k <= UINT32_MAX / 4 && want < 2 * e->cache_k) want = 2 * e->cache_k;
+
+	epoch_free_tables(e);
+	e->prime_cache = primes_upto(want);
+	e->cache_k = want;
+
+	uint32_t n = e->prime_cache.count;
+	if (n == 0) return;
+
+	e->fd = (FastDivU32*)sys_alloc((size_t)n * sizeof(FastDivU32));
+	e->inv = (ExactDivU64*)sys_alloc((size_t)n * sizeof(ExactDivU64));
+	e->step_mod = (uint32_t*)sys_alloc((size_t)n * sizeof(uint32_t));
+	if (!e->prime_cache.p || !e->fd || !e->inv || !e->step_mod) {
+		fprintf(stderr, "alloc failed for prime tables (count=%u)\n", n);
+		exit(2);
+	}
+
+	for (uint32_t i = 0; i < n; ++i) {
+		uint32_t p = e->prime_cache.p[i];
+		e->fd[i] = fastdiv_u32_make_prime(p);
+		e->inv[i] = exactdiv_make(p);
+	}
+}
+
+// Tables for e->k with e->step and e->tile_len. Workers' off[] stay valid across k (the
+// prime order is fixed), so math_gen only moves when the log kernel's powers are involved.
+static void epoch_prepare_math(JobSystem* js) {
+	Epoch* e = &js->epoch;
+
+	epoch_free_math(e);
+	if (e->kernel == KERNEL_LOG || e->math_log) ++e->math_gen;
+	e->math_log = (e->kernel == KERNEL_LOG);
+
+	if (e->cache_k < e->k) epoch_grow_tables(e, e->k);
+
+	uint32_t n = 0;
+	while (n < e->prime_cache.count && e->prime_cache.p[n] <= e->k) ++n;
+	e->primes.p = e->prime_cache.p;
+	e->primes.count = n;
+
+	if (e->cache_step != e->step) {
+		for (uint32_t i = 0; i < e->prime_cache.count; ++i) {
+			uint32_t p = e->prime_cache.p[i];
+			if (p == 2) e->step_mod[i] = (uint32_t)(e->step & 1ull);
+			else        e->step_mod[i] = fastdiv_u32_mod(&e->fd[i], e->step);
+		}
+		e->cache_step = e->step;
+		epoch_replicate_tables(e);
+	}
+
+	if (e->kernel == KERNEL_LOG) epoch_prepare_log_powers(e);
+	if (e->origin && !e->inv128) epoch_build_wide(e);
+
+	// Bucket primes must hit a full window at most once, and a lane's tiles must be adjacent.
+	// Contiguous windows never exceed tile_len (find lanes carry the run instead of +k).
+	e->bucket_win = e->tile_len;
+	e->bucket_first = n;
+	if (e->bucket && e->schedule == SCHED_CONTIG && e->kernel == KERNEL_EXACT && !e->origin) {
+		uint32_t first = 0;
+		while (first < n && e->primes.p[first] < e->bucket_win) ++first;
+		e->bucket_first = first;
+	}
+
+	e->wheel = (e->kernel != KERNEL_LOG && e->bucket_first >= WHEEL_PRIMES);
+}
+
+static uint64_t epoch_step(const JobSystem* js, uint32_t tile_len) {
+	if (js->epoch.schedule != SCHED_STRIDED) return tile_len;
+	return (uint64_t)tile_len * (uint64_t)js->thread_count;
+}
+
+// ------------------------------------------------------------
+// Sieve (carried offsets + FastDiv in factor stripping)
+// ------------------------------------------------------------
+//
+// base_test = m0 + 1
+// off[pi]   = smallest i>=0 such that (base_test + i) % p == 0, carried across tiles
+//
+
+// Divide every factor p out of residual[i]; with lpf, record p if that leaves 1.
+static FORCEINLINE void strip_hit(uint64_t* residual, uint32_t i, uint32_t p, const ExactDivU64* f, uint32_t* lpf) {
+	uint64_t x = residual[i];
+
+	// x is a multiple of p here (by construction): the first division needs no test
+	if (p == 2) {
+		x >>= (uint64_t)__builtin_ctzll(x);
+	}
+	else {
+		x *= f->inv;
+		while (exactdiv_divide_if_divisible(f, &x)) { /* repeat */ }
+	}
+	if (lpf && x == 1) lpf[i] = p;
+	residual[i] = x;
+}
+
+// Finish odd wheel primes whose square divides the value.
+static void wheel_strip_squares(const ExactDivU64* inv, uint64_t base_test, uint32_t n, uint64_t* residual) {
+	for (uint32_t j = 0; j < WHEEL_PRIMES - 1; ++j) {
+		uint32_t p = wheel_odd[j];
+		uint32_t q = p * p;
+		uint32_t r = (uint32_t)(base_test % q);
+		for (uint32_t i = r ? q - r : 0; i < n; i += q) strip_hit(residual, i, p, &inv[j + 1], NULL);
+	}
+}
+
+// Place a multiple at window offset i (relative to the tile d tiles ahead of cur) into the
+// bucket of the first tile whose window contains it.
+static FORCEINLINE void bucket_schedule(BucketRing* br, uint32_t tile_len, uint32_t win, uint32_t d, uint32_t pi, uint32_t i) {
+	while (i >= win) { i -= tile_len; ++d; }
+
+	uint32_t b = br->cur + d;
+	if (b >= br->nb) b -= br->nb;
+
+	BucketHit* h = &br->hit[(size_t)b * br->per + br->count[b]++];
+	h->pi = pi;
+	h->i = i;
+}
+
+// Strip this tile's bucket hits, then re-bucket each prime at its next landing.
+// Hits arrive in ring order, not prime order, so lpf keeps the largest bucket prime
+// (the caller zeroes lpf[] first).
+static void bucket_strip_tile(const Epoch* e, const EpochTables* t, BucketRing* br, uint32_t win_len, uint64_t* residual, uint32_t* lpf) {
+	const uint32_t* primes = t->primes;
+	const ExactDivU64* inv = t->inv;
+	uint32_t tile_len = e->tile_len;
+	uint32_t win = e->bucket_win;
+
+	uint32_t b = br->cur;
+	uint32_t n = br->count[b];
+	const BucketHit* h = &br->hit[(size_t)b * br->per];
+
+	for (uint32_t j = 0; j < n; ++j) {
+		uint32_t pi = h[j].pi;
+		uint32_t i = h[j].i;
+		uint32_t p = primes[pi];
+
+		if (i < win_len) {
+			strip_hit(residual, i, p, &inv[pi], NULL);
+			if (lpf && lpf[i] < p) lpf[i] = p;
+		}
+
+		// the same multiple if it is in the +k overlap, else the next one; never this tile again
+		uint32_t nxt = (i >= tile_len) ? i : i + p;
+		bucket_schedule(br, tile_len, win, 1, pi, nxt - tile_len);
+	}
+
+	br->count[b] = 0;
+	br->cur = (b + 1 == br->nb) ? 0 : b + 1;
+}
+
+static void sieve_window_bad_bits_carried_fastdiv(
+	const Epoch* e,
+	const EpochTables* t,
+	uint64_t base_test,
+	uint32_t win_len,
+	uint32_t* off,          // in/out [prime_count]
+	BucketRing* br,         // in/out, Epoch.bucket only
+	uint64_t* residual,     // [win_len]
+	uint8_t* bad_bits      // bitset [win_len]
+) {
+	uint32_t pc = e->bucket_first;
+	const uint32_t* primes = t->primes;
+	const ExactDivU64* inv = t->inv;
+	const uint32_t* step_mod = t->step_mod;
+
+	uint32_t p0 = 0;
+	if (e->wheel) {
+		wheel_fill(residual, NULL, base_test, win_len);
+		wheel_strip_squares(inv, base_test, win_len, residual);
+		p0 = WHEEL_PRIMES;
+	}
+	else {
+		g_simd.iota_u64(residual, base_test, win_len);
+	}
+
+	// SIMD stage: odd p < 64 over whole vectors; the scalar loop below finishes the tail
+	uint32_t s0 = p0 ? p0 : 1, ns = s0, nfull = 0;
+	if (g_simd.strip_small && pc > s0) {
+		ns = (pc < SIMD_SMALL_END) ? pc : SIMD_SMALL_END;
+		nfull = win_len - win_len % g_simd.lanes;
+		g_simd.strip_small(residual, nfull, off, s0, ns);
+	}
+
+	for (uint32_t pi = p0; pi < pc; ++pi) {
+		uint32_t p = primes[pi];
+
+		uint32_t i0 = off[pi];
+		if (pi >= s0 && pi < ns && i0 < nfull) i0 += ((nfull - i0 + p - 1) / p) * p;
+
+		// process multiples inside this window
+		for (uint32_t i = i0; i < win_len; i += p) strip_hit(residual, i, p, &inv[pi], NULL);
+
+		// carry offset to next tile in this worker stream:
+		// base_test' = base_test + step, so off' = off - (step % p) mod p
+		uint32_t sm = step_mod[pi];
+		if (sm) {
 			uint32_t o = off[pi];
 			off[pi] = (o >= sm) ? (o - sm) : (o + p - sm);
 		}
 	}
+	if (pc < e->primes.count) bucket_strip_tile(e, t, br, win_len, residual, NULL);
+
+	// k-smooth iff residual == 1
+	g_simd.ones_to_bits(residual, win_len, bad_bits);
+}
+
+// ------------------------------------------------------------
+// Sweep kernel: same stripping, but record the prime that reduced each value to 1.
+// Primes are stripped in increasing order, so that prime is the largest prime factor,
+// and x is k-smooth exactly when it is K-smooth with lpf <= k.
+// ------------------------------------------------------------
+
+static void sieve_window_lpf_carried_fastdiv(
+	const Epoch* e,
+	const EpochTables* t,
+	uint64_t base_test,
+	uint32_t win_len,
+	uint32_t* off,          // in/out [prime_count]
+	BucketRing* br,         // in/out, Epoch.bucket only
+	uint64_t* residual,     // [win_len]
+	uint32_t* lpf           // [win_len], valid where residual == 1
+) {
+	uint32_t pc = e->bucket_first;
+	const uint32_t* primes = t->primes;
+	const ExactDivU64* inv = t->inv;
+	const uint32_t* step_mod = t->step_mod;
+
+	// the wheel writes every lpf[], so later primes (all larger) just overwrite on reaching 1
+	uint32_t p0 = 0;
+	if (e->wheel) {
+		wheel_fill(residual, lpf, base_test, win_len);
+		wheel_strip_squares(inv, base_test, win_len, residual);
+		p0 = WHEEL_PRIMES;
+	}
+	else {
+		g_simd.iota_u64(residual, base_test, win_len);
+		if (pc < e->primes.count) memset(lpf, 0, (size_t)win_len * sizeof(uint32_t));
+	}
+
+	for (uint32_t pi = p0; pi < pc; ++pi) {
+		uint32_t p = primes[pi];
+
+		for (uint32_t i = off[pi]; i < win_len; i += p) strip_hit(residual, i, p, &inv[pi], lpf);
+
+		uint32_t sm = step_mod[pi];
+		if (sm) {
+			uint32_t o = off[pi];
+			off[pi] = (o >= sm) ? (o - sm) : (o + p - sm);
+		}
+	}
+	if (pc < e->primes.count) bucket_strip_tile(e, t, br, win_len, residual, lpf);
+}
+
+static void sweep_tile_push(SweepTile* t, uint32_t i, uint32_t q) {
+	if (t->count == t->cap) {
+		uint32_t cap = t->cap ? t->cap * 2 : 1024;
+		SmoothHit* h = (SmoothHit*)realloc(t->hit, (size_t)cap * sizeof(SmoothHit));
+		if (!h) {
+			fprintf(stderr, "realloc failed for sweep tile (cap=%u)\n", cap);
+			exit(2);
+		}
+		t->hit = h;
+		t->cap = cap;
+	}
+	t->hit[t->count].i = i;
+	t->hit[t->count].q = q;
+	++t->count;
+}
+
+static void sweep_tile_collect(
+	uint64_t base_test,
+	uint32_t win_len,
+	const uint64_t* residual,
+	const uint32_t* lpf,
+	SweepTile* out
+) {
+	out->count = 0;
+	for (uint32_t i = 0; i < win_len; ++i) {
+		if (residual[i] != 1) continue;
+		sweep_tile_push(out, i, (base_test + (uint64_t)i == 1) ? 1u : lpf[i]);
+	}
+}
+
+// ------------------------------------------------------------
+// Log kernel: byte log sums as a smoothness pre-filter
+// ------------------------------------------------------------
+//
+// logs[i] += ceil(scale*log2 p) for every prime power p^e dividing x = base_test + i.
+// For k-smooth x the sum is >= scale*log2(x) >= thr, so any position below thr is
+// certainly not smooth. Non-smooth x keep a cofactor > k and fall short by about
+// scale*log2(k) units, so the candidates that pass are almost all truly smooth and are
+// confirmed by exact trial division. off[] here is indexed by prime power, not prime.
+//
+
+// Largest prime factor of x if x is K-smooth (K = e->k, 1 for x == 1), else 0.
+static uint32_t smooth_lpf_trial(const Epoch* e, const EpochTables* t, uint64_t x) {
+	if (x == 1) return 1;
+
+	uint32_t pc = e->primes.count;
+	const uint32_t* primes = t->primes;
+	const ExactDivU64* inv = t->inv;
+	if (pc == 0) return 0;
+
+	uint32_t last = 0;
+	if (!(x & 1)) {
+		x >>= (uint64_t)__builtin_ctzll(x);
+		last = 2;
+	}
+
+	for (uint32_t pi = 1; pi < pc; ++pi) {
+		if (x == 1) return last;
+
+		uint32_t p = primes[pi];
+		if ((uint64_t)p * p > x) return (x <= e->k) ? (uint32_t)x : 0; // x is prime
+
+		if (exactdiv_divide_if_divisible(&inv[pi], &x)) {
+			while (exactdiv_divide_if_divisible(&inv[pi], &x)) { /* repeat */ }
+			last = p;
+		}
+	}
+	return (x == 1) ? last : 0;
+}
+
+// Threshold for a window starting at base_test (log2 grows across it, so this is a floor).
+static uint8_t log_threshold(const Epoch* e, uint64_t base_test) {
+	double t = floor((double)e->log_scale * log2((double)base_test) - 1e-6);
+	if (t <= 0.0) return 0;
+	if (t >= 255.0) return 255;
+	return (uint8_t)t;
+}
+
+static void sieve_window_logs_carried(
+	const Epoch* e,
+	uint32_t win_len,
+	uint32_t* off,          // in/out [pow_count]
+	uint8_t* logs           // [win_len]
+) {
+	memset(logs, 0, win_len);
+
+	uint32_t n = e->pow_count;
+	uint32_t top = e->pow_top_first;
+	const uint32_t* pow_q = e->pow_q;
+	const uint32_t* step_mod = e->pow_step_mod;
+	const uint8_t* pow_log = e->pow_log;
+
+	for (uint32_t j = 0; j < n; ++j) {
+		uint32_t q = pow_q[j];
+
+		if (j < top) {
+			uint8_t v = pow_log[j];
+			for (uint32_t i = off[j]; i < win_len; i += q) logs[i] += v;
+		}
+		else {
+			// untracked higher powers may follow: let the exact check decide
+			for (uint32_t i = off[j]; i < win_len; i += q) logs[i] = 0xFF;
+		}
+
+		uint32_t sm = step_mod[j];
+		if (sm) {
+			uint32_t o = off[j];
+			off[j] = (o >= sm) ? (o - sm) : (o + q - sm);
+		}
+	}
+}
+
+static void sieve_window_bad_bits_log(
+	const Epoch* e,
+	const EpochTables* t,
+	uint64_t base_test,
+	uint32_t win_len,
+	uint32_t* off,          // in/out [pow_count]
+	uint8_t* logs,          // [win_len]
+	uint8_t* bad_bits       // bitset [win_len]
+) {
+	uint8_t thr = log_threshold(e, base_test);
+
+	sieve_window_logs_carried(e, win_len, off, logs);
+	bitset_clear(bad_bits, win_len);
+
+	for (uint32_t i = 0; i < win_len; ++i) {
+		if (logs[i] < thr) continue;
+		if (smooth_lpf_trial(e, t, base_test + (uint64_t)i)) bitset_set(bad_bits, i);
+	}
+}
+
+static void sweep_tile_collect_log(
+	const Epoch* e,
+	const EpochTables* t,
+	uint64_t base_test,
+	uint32_t win_len,
+	uint32_t* off,          // in/out [pow_count]
+	uint8_t* logs,          // [win_len]
+	SweepTile* out
+) {
+	uint8_t thr = log_threshold(e, base_test);
+
+	sieve_window_logs_carried(e, win_len, off, logs);
+
+	out->count = 0;
+	for (uint32_t i = 0; i < win_len; ++i) {
+		if (logs[i] < thr) continue;
+		uint32_t q = smooth_lpf_trial(e, t, base_test + (uint64_t)i);
+		if (q) sweep_tile_push(out, i, q);
+	}
+}
+
+// ------------------------------------------------------------
+// Lean kernel: a u32 per position, the value base_test + i stays implicit
+// ------------------------------------------------------------
+//
+// For the odd part o of x, lean[i] keeps P = product of the stripped odd chunks mod 2^24
+// and L = sum of floor(4 log2 chunk), from below within 2 (quarter bits, top 8 bits). A
+// stride-p hit folds in p unchecked; the p^2 stride folds in the rest, p^(e-1). The wheel
+// adds its primes as one chunk. o < 2^64 has at most 14 odd primes, so at most 29 chunks:
+//   smooth x:      P == o mod 2^24, and L > 4 log2 o - 58
+//   cofactor c>1:  P == o mod 2^24 only if c == 1 mod 2^24, and then L <= 4 log2 o - 96
+// With G = floor(4 log2 o) +-1 (from a double), x is k-smooth iff P == o mod 2^24 and
+// L + LEAN_SLACK >= G.
+//
+
+static uint32_t g_lean_wheel[32];   // [wheel set] start word after the odd wheel primes
+
+// floor(4 log2 c), or at most 2 below it for c >= 2^16
+static FORCEINLINE uint32_t lean_log4(uint64_t c) {
+	uint32_t h = 63u - (uint32_t)__builtin_clzll(c);
+	if (h < 16) return 63u - (uint32_t)__builtin_clzll(c * c * c * c);
+	uint64_t m = c >> (h - 15);
+	return 4u * (h - 15) + 63u - (uint32_t)__builtin_clzll(m * m * m * m);
+}
+
+static void lean_init(void) {
+	for (uint32_t m = 0; m < 32; ++m) {
+		uint32_t d = 1;
+		for (uint32_t j = 0; j < WHEEL_PRIMES - 1; ++j)
+			if (m & (1u << j)) d *= wheel_odd[j];
+		g_lean_wheel[m] = d | (lean_log4(d) << LEAN_BITS);
+	}
+}
+
+static FORCEINLINE void lean_fold(uint32_t* lean, uint64_t i, uint64_t c, uint32_t l4) {
+	uint32_t w = lean[i];
+	lean[i] = ((w * (uint32_t)c) & LEAN_MASK) | ((w & ~LEAN_MASK) + (l4 << LEAN_BITS));
+}
+
+// p^2 | base_test + i: fold the p^(e-1) left after the p already counted.
+static FORCEINLINE void lean_fold_rest(uint32_t* lean, uint64_t i, uint64_t base_test, uint32_t p, const ExactDivU64* f) {
+	uint64_t x = (base_test + i) * f->inv;
+	uint64_t pe = 1;
+	while (exactdiv_divide_if_divisible(f, &x)) pe *= p;
+	lean_fold(lean, i, pe, lean_log4(pe));
+}
+
+static void sieve_window_bad_bits_lean(
+	const Epoch* e,
+	const EpochTables* t,
+	uint64_t base_test,
+	uint32_t win_len,
+	uint32_t* off,          // in/out [prime_count]
+	uint32_t* lean,         // [win_len]
+	uint8_t* bad_bits       // bitset [win_len]
+) {
+	uint32_t pc = e->primes.count;
+	const uint32_t* primes = t->primes;
+	const FastDivU32* fd = t->fd;
+	const ExactDivU64* inv = t->inv;
+	const uint32_t* step_mod = t->step_mod;
+
+	uint32_t p0 = 0;
+	if (e->wheel) {
+		uint32_t r = (uint32_t)(base_test % WHEEL_MOD);
+		for (uint32_t i = 0; i < win_len; ++i) {
+			lean[i] = g_lean_wheel[g_wheel.set[r]];
+			if (++r == WHEEL_MOD) r = 0;
+		}
+		for (uint32_t j = 0; j < WHEEL_PRIMES - 1; ++j) {
+			uint32_t q = wheel_odd[j] * wheel_odd[j];
+			uint32_t rq = (uint32_t)(base_test % q);
+			for (uint32_t i = rq ? q - rq : 0; i < win_len; i += q) lean_fold_rest(lean, i, base_test, wheel_odd[j], &inv[j + 1]);
+		}
+		p0 = WHEEL_PRIMES;
+	}
+	else {
+		for (uint32_t i = 0; i < win_len; ++i) lean[i] = 1;
+	}
+
+	for (uint32_t pi = p0; pi < pc; ++pi) {
+		uint32_t p = primes[pi];
+		uint32_t o = off[pi];
+
+		// 2 is never folded in: the final test compares odd parts
+		if (p != 2 && o < win_len) {
+			uint32_t l4 = lean_log4(p);
+			for (uint32_t i = o; i < win_len; i += p) lean_fold(lean, i, p, l4);
+
+			// first multiple of p^2: (base_test + o) / p must be 0 mod p
+			const FastDivU32* f = &fd[pi];
+			uint64_t y; uint32_t r;
+			fastdiv_u32_divmod(f, base_test + o, &y, &r);
+			uint32_t t = fastdiv_u32_mod(f, y);
+			uint64_t q = (uint64_t)p * p;
+			uint64_t i2 = o + (uint64_t)(t ? p - t : 0) * p;
+			for (uint64_t i = i2; i < win_len; i += q) lean_fold_rest(lean, i, base_test, p, &inv[pi]);
+		}
+
+		uint32_t sm = step_mod[pi];
+		if (sm) off[pi] = (o >= sm) ? (o - sm) : (o + p - sm);
+	}
+
+	g_simd.lean_to_bits(lean, base_test, win_len, pc ? 63u : 0u, bad_bits);   // k < 2: 2 not stripped
+}
+
+// ------------------------------------------------------------
+// Wide kernel: values origin + base_test + i past 2^64
+// ------------------------------------------------------------
+//
+// Positions stay u64 offsets from Epoch.origin, so batches, lanes, off[] and the run finder
+// are the 64-bit ones; only the residual is u128, stripped with inverses mod 2^128. Every
+// window takes this path once main has rebased the search (origin != 0), none before it.
+// No wheel, SIMD stage or bucket ring: main falls back to KERNEL_EXACT without buckets.
+//
+
+static FORCEINLINE void strip_hit_wide(u128* residual, uint32_t i, uint32_t p, const ExactDivU128* f) {
+	u128 x = residual[i];
+
+	if (p == 2) {
+		uint64_t lo = (uint64_t)x;
+		x >>= lo ? (uint32_t)__builtin_ctzll(lo) : 64u + (uint32_t)__builtin_ctzll((uint64_t)(x >> 64));
+	}
+	else {
+		x *= f->inv;
+		while (exactdiv128_divide_if_divisible(f, &x)) { /* repeat */ }
+	}
+	residual[i] = x;
+}
+
+static void sieve_window_bad_bits_wide(
+	const Epoch* e,
+	const EpochTables* t,
+	uint64_t base_test,
+	uint32_t win_len,
+	uint32_t* off,          // in/out [prime_count]
+	u128* residual,         // [win_len]
+	uint8_t* bad_bits       // bitset [win_len]
+) {
+	uint32_t pc = e->primes.count;
+	const uint32_t* primes = t->primes;
+	const ExactDivU128* inv = t->inv128;
+	const uint32_t* step_mod = t->step_mod;
+
+	u128 x0 = e->origin + base_test;
+	for (uint32_t i = 0; i < win_len; ++i) residual[i] = x0 + i;
+
+	for (uint32_t pi = 0; pi < pc; ++pi) {
+		uint32_t p = primes[pi];
+		for (uint32_t i = off[pi]; i < win_len; i += p) strip_hit_wide(residual, i, p, &inv[pi]);
+
+		uint32_t sm = step_mod[pi];
+		if (sm) {
+			uint32_t o = off[pi];
+			off[pi] = (o >= sm) ? (o - sm) : (o + p - sm);
+		}
+	}
+
+	bitset_clear(bad_bits, win_len);
+	for (uint32_t i = 0; i < win_len; ++i)
+		if (residual[i] == 1) bitset_set(bad_bits, i);
+}
+
+// ------------------------------------------------------------
+// Tile scan: sieve one window, then feed bad_bits to the lane's run finder
+// ------------------------------------------------------------
+
+// Sieves m0+1 .. m0+win_len. Returns the start m of the first run of k non-smooth values
+// that ends in this window (it may begin in an earlier window of the run), else UINT64_MAX.
+static uint64_t scan_tile_find_m_carried_fastdiv(
+	const Epoch* e,
+	const EpochTables* t,
+	uint64_t m0,
+	uint32_t win_len,
+	uint32_t* off,          // in/out (advanced by one tile)
+	BucketRing* br,
+	uint64_t* residual,
+	uint8_t* logs,          // KERNEL_LOG only
+	uint32_t* lean,         // KERNEL_LEAN only
+	u128* wide,             // Epoch.origin != 0 only
+	uint8_t* bad_bits,
+	ZeroRun* run            // in/out: clear run ending at m0
+) {
+	if (win_len == 0) return UINT64_MAX;
+
+	if      (UNLIKELY(e->origin))      sieve_window_bad_bits_wide(e, t, m0 + 1, win_len, off, wide, bad_bits);
+	else if (e->kernel == KERNEL_LOG)  sieve_window_bad_bits_log(e, t, m0 + 1, win_len, off, logs, bad_bits);
+	else if (e->kernel == KERNEL_LEAN) sieve_window_bad_bits_lean(e, t, m0 + 1, win_len, off, lean, bad_bits);
+	else                               sieve_window_bad_bits_carried_fastdiv(e, t, m0 + 1, win_len, off, br, residual, bad_bits);
+
+	uint32_t i = g_simd.zero_run_feed(run, bad_bits, win_len, e->k);
+	return (i == UINT32_MAX) ? UINT64_MAX : m0 + (uint64_t)i + 1 - e->k;
+}
+
+// ------------------------------------------------------------
+// Plateau extension: the true length of the clear run from m+1
+// ------------------------------------------------------------
+//
+// The length is the largest z with P(m+i) > z for every i <= z (P: largest prime factor).
+// The lpf kernel strips primes in increasing order, so the prime at which a value reaches
+// 1 is its P; a value that never does has P > e->k. One pass over consecutive windows
+// keeps z and the smallest P seen, so no value is sieved twice however long the run is.
+// The answer is exact while z < e->k: at z == e->k the caller must raise the bound.
+//
+
+typedef struct PlateauRun {
+	uint32_t z;         // m+1 .. m+z scanned, every P(m+i) > z
+	uint32_t q_min;     // smallest P among them (UINT32_MAX: none smooth over e->k)
+} PlateauRun;
+
+// Sieves m+z+1 .. m+z+win_len (base_test = m+z+1). Returns 1 once the run has ended
+// (its length is pr->z), 0 if it covers the window (or reaches the prime bound).
+static int scan_window_plateau_carried_fastdiv(
+	const Epoch* e,
+	const EpochTables* t,
+	uint64_t base_test,
+	uint32_t win_len,
+	uint32_t* off,          // in/out (advanced by one step)
+	BucketRing* br,
+	uint64_t* residual,     // [win_len]
+	uint32_t* lpf,          // [win_len]
+	PlateauRun* pr          // in/out
+) {
+	sieve_window_lpf_carried_fastdiv(e, t, base_test, win_len, off, br, residual, lpf);
+
+	uint32_t q_min = pr->q_min;
+	for (uint32_t i = 0; i < win_len && pr->z < e->k; ++i) {
+		if (residual[i] == 1) {
+			uint32_t q = (base_test + i == 1) ? 1u : lpf[i];
+			if (q < q_min) q_min = q;
+		}
+		if (q_min <= pr->z + 1) {
+			pr->q_min = q_min;
+			return 1;
+		}
+		++pr->z;
+	}
+	pr->q_min = q_min;
+	return 0;
+}
+
+// ------------------------------------------------------------
+// Worker epoch init: initialize off[] for base_test0 once per lane (or per steal)
+// off[pi] = (p - (base_test0 % p)) % p, using FastDiv (no idiv), plus p==2 special.
+// Bucket primes are moved from off[] into the lane's ring instead.
+// Skipped when the worker's last window already left off[] at base_test0, e.g. a
+// strided lane flowing into the same lane of the next batch.
+// ------------------------------------------------------------
+
+// Find cutoff for lanes of es: the batch end, or end_limit once something was found.
+static FORCEINLINE uint64_t epoch_limit(const Epoch* e, const EpochSlot* es) {
+	uint64_t lim = load_u64((shared_u64*)&e->end_limit);
+	return (lim < es->end_m) ? lim : es->end_m;
+}
+
+// First tile base (m0) of a lane in a batch.
+static uint64_t epoch_lane_base(const Epoch* e, const EpochSlot* es, uint32_t lane) {
+	if (e->schedule == SCHED_CONTIG) return es->start_m + (uint64_t)lane * es->lane_span;
+	return es->start_m + (uint64_t)lane * (uint64_t)e->tile_len;
+}
+
+// off[] now stands at the window after the one starting at base_test.
+static FORCEINLINE void worker_advance_offsets(WorkerCtx* w, uint64_t base_test) {
+	w->off_next = base_test + w->js->epoch.step;
+}
+
+static void worker_init_offsets(WorkerCtx* w, uint64_t base_test0) {
+	const Epoch* e = &w->js->epoch;
+	const EpochTables* t = &e->tab[w->node];
+	uint32_t pc = e->primes.count;
+
+	// the bucket ring is rebuilt every time; it does not track partial windows. Entries
+	// past pc stop being advanced, so only the first off_count stay positioned.
+	uint32_t from = 0;
+	if (w->off_gen == e->math_gen && w->off_next == base_test0 && e->bucket_first == pc) {
+		if (e->kernel == KERNEL_LOG || w->off_count >= pc) {
+			if (w->off_count > pc) w->off_count = pc;
+			return;
+		}
+		from = w->off_count;   // same position for a larger k: only the new primes
+	}
+	w->off_gen = e->math_gen;
+	w->off_next = base_test0;
+
+	if (e->kernel == KERNEL_LOG) {
+		// once per epoch per power; plain division is fine here
+		w->off_count = 0;
+		ensure_worker_off(w, e->pow_count);
+		for (uint32_t j = 0; j < e->pow_count; ++j) {
+			uint32_t q = e->pow_q[j];
+			uint32_t r = (uint32_t)(base_test0 % q);
+			w->off[j] = r ? (q - r) : 0u;
+		}
+		return;
+	}
+
+	ensure_worker_off(w, pc);
+	w->off_count = pc;
+	if (pc == 0) return;
+
+	u128 x0 = e->origin + base_test0;
+	for (uint32_t pi = from; pi < pc; ++pi) {
+		uint32_t p = t->primes[pi];
+		if (p == 2) {
+			w->off[pi] = (uint32_t)(x0 & 1u); // even => 0, odd => 1
+		}
+		else {
+			uint32_t r = fastdiv_u32_mod_u128(&t->fd[pi], x0);
+			w->off[pi] = r ? (p - r) : 0u;
+		}
+	}
+
+	if (e->bucket_first < pc) {
+		uint32_t nb = t->primes[pc - 1] / e->tile_len + 2;
+		ensure_worker_buckets(w, nb, pc - e->bucket_first);
+		for (uint32_t pi = e->bucket_first; pi < pc; ++pi)
+			bucket_schedule(&w->br, e->tile_len, e->bucket_win, 0, pi, w->off[pi]);
+	}
+}
+
+static void worker_init_offsets_for_epoch(WorkerCtx* w, const EpochSlot* es, uint32_t lane) {
+	worker_init_offsets(w, epoch_lane_base(&w->js->epoch, es, lane) + 1);
+}
+
+// Tally one sieved window base_test .. base_test + len - 1.
+static FORCEINLINE void worker_count_tile(WorkerCtx* w, uint64_t base_test, uint32_t len) {
+	w->stat[STAT_TILES] += 1;
+	w->stat[STAT_VALUES] += len;
+#if STATS_HOT
+	const Epoch* e = &w->js->epoch;
+	uint64_t lo = base_test - 1, hi = lo + len;
+	for (uint32_t pi = 0; pi < e->primes.count; ++pi)
+		w->stat[STAT_HITS] += hi / e->primes.p[pi] - lo / e->primes.p[pi];
+#else
+	(void)base_test;
+#endif
+}
+
+static void worker_publish_stats(WorkerCtx* w) {
+#if STATS_HOT
+	w->stat[STAT_FD_FIX] = g_fd_fix;
+#endif
+	shared_u64* row = w->js->stats.pub + (size_t)w->tid * STAT_COUNT;
+	for (uint32_t i = 0; i < STAT_COUNT; ++i) store_u64(&row[i], w->stat[i]);
+}
+
+// ------------------------------------------------------------
+// Work stealing: one packed [lo, hi) tile range per lane
+// ------------------------------------------------------------
+//
+// The owner pops tiles from lo; an idle worker splits the upper half off the largest
+// range and adopts it as its own. Both ends move by CAS on the same word, so a tile is
+// handed out exactly once. Ranges only shrink, and a worker adopts a range only while
+// its own is empty, so no stale value can match again (no ABA).
+//
+
+#define STEAL_NONE UINT32_MAX
+
+static FORCEINLINE uint64_t steal_pack(uint32_t lo, uint32_t hi) { return ((uint64_t)hi << 32) | lo; }
+
+static uint32_t steal_pop(EpochSlot* es, uint32_t lane) {
+	shared_u64* r = &es->steal[lane];
+	for (;;) {
+		uint64_t v = load_u64(r);
+		uint32_t lo = (uint32_t)v, hi = (uint32_t)(v >> 32);
+		if (lo >= hi) return STEAL_NONE;
+		if (cas_u64(r, v, steal_pack(lo + 1, hi))) return lo;
+	}
+}
+
+static uint32_t steal_take(JobSystem* js, EpochSlot* es, uint32_t lane) {
+	for (;;) {
+		uint32_t victim = STEAL_NONE, most = 0;
+		uint64_t seen = 0;
+		for (uint32_t i = 0; i < js->thread_count; ++i) {
+			uint64_t v = load_u64(&es->steal[i]);
+			uint32_t lo = (uint32_t)v, hi = (uint32_t)(v >> 32);
+			if (hi > lo && hi - lo > most) { most = hi - lo; victim = i; seen = v; }
+		}
+		if (victim == STEAL_NONE) return STEAL_NONE;
+
+		uint32_t lo = (uint32_t)seen, hi = (uint32_t)(seen >> 32);
+		uint32_t mid = hi - (most + 1) / 2;
+		if (!cas_u64(&es->steal[victim], seen, steal_pack(lo, mid))) continue;
+
+		// take mid now; mid+1..hi stays stealable from this lane
+		store_u64(&es->steal[lane], steal_pack(mid + 1, hi));
+		return mid;
+	}
+}
+
+// ------------------------------------------------------------
+// Worker thread (strided or contiguous lanes)
+// ------------------------------------------------------------
+
+// SCHED_CONTIG: sieve only the lane's own values lb+1 .. v_end, each exactly once. Runs
+// inside the lane are found here; head/tail counts go to lane_runs[lane] for stitching.
+static void worker_run_find_lane(WorkerCtx* w, const EpochSlot* es, uint32_t lane) {
+	JobSystem* js = w->js;
+	const Epoch* e = &js->epoch;
+	LaneRun* lr = &es->lane_runs[lane];
+	uint32_t k = e->k;
+
+	uint64_t lb = epoch_lane_base(e, es, lane);
+	uint64_t v_end = lb + es->lane_span;
+	if (v_end > es->end_m + 1) v_end = es->end_m + 1;
+
+	memset(lr, 0, sizeof(*lr));
+	if (lb >= v_end) { lr->complete = 1; return; }
+
+	worker_init_offsets_for_epoch(w, es, lane);
+	ensure_worker_find(w, e, e->tile_len);
+
+	uint64_t base = lb;
+	ZeroRun run = { 0 };
+	int head_open = 1;
+
+	for (;;) {
+		if (base >= v_end) { lr->complete = 1; break; }
+
+		// the open run starts at base - gap, or up to k-1 earlier while it is still the
+		// lane's head (the previous lane's tail may extend it)
+		uint64_t lim = epoch_limit(e, es);
+		uint64_t reach = run.gap + (head_open ? k - 1u : 0u);
+		if (base > lim && base - lim > reach) break;
+		if (lim + k <= base) break;   // values past lim+k decide no start <= lim
+
+		uint64_t want = v_end - base;
+		if (want > lim + k - base) want = lim + k - base;
+		uint32_t win_len = (want < e->tile_len) ? (uint32_t)want : e->tile_len;
+
+		uint64_t found = scan_tile_find_m_carried_fastdiv(e, &e->tab[w->node], base, win_len, w->off, &w->br, w->residual, w->logs, w->lean, w->wide, w->bad_bits, &run);
+		worker_advance_offsets(w, base + 1);
+		worker_count_tile(w, base + 1, win_len);
+		if (head_open) {
+			uint32_t f = bitset_first_set(w->bad_bits, win_len);
+			lr->head += f;
+			head_open = (f == win_len);
+		}
+
+		// runs surface in increasing start order, so the first one ends the lane
+		if (found != UINT64_MAX) {
+			if (found <= lim) try_set_best(js, found);
+			break;
+		}
+
+		base += win_len;
+		if (win_len < e->tile_len) { lr->complete = (base >= v_end); break; }
+	}
+
+	lr->len = base - lb;
+	lr->tail = run.gap;
+}
+
+// SCHED_STRIDED: independent windows of start_count + k per tile.
+static void worker_run_find_epoch(WorkerCtx* w, const EpochSlot* es, uint32_t lane) {
+	JobSystem* js = w->js;
+	const Epoch* e = &js->epoch;
+
+	if (e->schedule == SCHED_CONTIG) {
+		worker_run_find_lane(w, es, lane);
+		return;
+	}
+
+	uint64_t base = epoch_lane_base(e, es, lane);
+	if (base > epoch_limit(e, es)) return;
+	worker_init_offsets_for_epoch(w, es, lane);
+
+	for (;;) {
+		uint64_t lim = epoch_limit(e, es);
+		if (base > lim) break;
+
+		uint64_t max_starts = (lim - base + 1);
+		uint32_t start_count = (max_starts >= e->tile_len) ? e->tile_len : (uint32_t)max_starts;
+
+		uint32_t win_len = start_count + e->k;
+		ensure_worker_find(w, e, win_len);
+
+		ZeroRun run = { 0 };
+		uint64_t found = scan_tile_find_m_carried_fastdiv(e, &e->tab[w->node], base, win_len, w->off, &w->br, w->residual, w->logs, w->lean, w->wide, w->bad_bits, &run);
+		worker_advance_offsets(w, base + 1);
+		worker_count_tile(w, base + 1, win_len);
+		if (found != UINT64_MAX) {
+			if (found <= lim) try_set_best(js, found);
+			break;
+		}
+
+		base += e->step;
+	}
+}
+
+// SCHED_STEAL: tiles in any order from the lane's range, then from the others'. off[] is
+// carried while tiles stay adjacent and re-derived only after a steal or a skipped tile.
+// Find tiles are independent start_count + k windows, so the order does not matter.
+static void worker_run_steal_epoch(WorkerCtx* w, EpochSlot* es, uint32_t lane) {
+	JobSystem* js = w->js;
+	const Epoch* e = &js->epoch;
+	int sweep = (e->mode == EPOCH_SWEEP);
+
+	if (sweep && e->kernel == KERNEL_LOG) ensure_worker_logs(w, e->tile_len);
+	else if (sweep) {
+		ensure_worker_buffers(w, e->tile_len);
+		ensure_worker_lpf(w, e->tile_len);
+	}
+
+	for (;;) {
+		uint32_t t = steal_pop(es, lane);
+		if (t == STEAL_NONE) t = steal_take(js, es, lane);
+		if (t == STEAL_NONE) break;
+
+		uint64_t base = es->start_m + (uint64_t)t * e->tile_len;
+		uint64_t lim = epoch_limit(e, es);
+		if (!sweep && base > lim) continue;   // drain tiles past the cutoff
+
+		worker_init_offsets(w, base + 1);
+
+		if (sweep) {
+			if (e->kernel == KERNEL_LOG) {
+				sweep_tile_collect_log(e, &e->tab[w->node], base + 1, e->tile_len, w->off, w->logs, &es->sweep_tiles[t]);
+			}
+			else {
+				sieve_window_lpf_carried_fastdiv(e, &e->tab[w->node], base + 1, e->tile_len, w->off, &w->br, w->residual, w->lpf);
+				sweep_tile_collect(base + 1, e->tile_len, w->residual, w->lpf, &es->sweep_tiles[t]);
+			}
+			worker_advance_offsets(w, base + 1);
+			worker_count_tile(w, base + 1, e->tile_len);
+			continue;
+		}
+
+		uint64_t max_starts = (lim - base + 1);
+		uint32_t start_count = (max_starts >= e->tile_len) ? e->tile_len : (uint32_t)max_starts;
+
+		uint32_t win_len = start_count + e->k;
+		ensure_worker_find(w, e, win_len);
+
+		ZeroRun run = { 0 };
+		uint64_t found = scan_tile_find_m_carried_fastdiv(e, &e->tab[w->node], base, win_len, w->off, &w->br, w->residual, w->logs, w->lean, w->wide, w->bad_bits, &run);
+		worker_advance_offsets(w, base + 1);
+		worker_count_tile(w, base + 1, win_len);
+		if (found != UINT64_MAX && found <= lim) try_set_best(js, found);
+	}
+}
+
+// Sweep epochs have no minimality cutoff: every tile [base+1, base+tile_len] is sieved
+// once (no +k overlap) and its K-smooth values go to the tile's slot for the main thread.
+static void worker_run_sweep_epoch(WorkerCtx* w, EpochSlot* es, uint32_t lane) {
+	JobSystem* js = w->js;
+	const Epoch* e = &js->epoch;
+
+	uint32_t slot = lane, slot_step = js->thread_count, slot_end = e->sweep_tile_count;
+	if (e->schedule == SCHED_CONTIG) {
+		uint32_t per_lane = (uint32_t)(es->lane_span / e->tile_len);
+		slot = lane * per_lane;
+		slot_step = 1;
+		if (slot >= slot_end) return;
+		if (slot_end - slot > per_lane) slot_end = slot + per_lane;
+	}
+
+	uint64_t base = epoch_lane_base(e, es, lane);
+	worker_init_offsets_for_epoch(w, es, lane);
+
+	if (e->kernel == KERNEL_LOG) {
+		ensure_worker_logs(w, e->tile_len);
+		for (; slot < slot_end; slot += slot_step) {
+			sweep_tile_collect_log(e, &e->tab[w->node], base + 1, e->tile_len, w->off, w->logs, &es->sweep_tiles[slot]);
+			worker_advance_offsets(w, base + 1);
+			worker_count_tile(w, base + 1, e->tile_len);
+			base += e->step;
+		}
+		return;
+	}
+
+	ensure_worker_buffers(w, e->tile_len);
+	ensure_worker_lpf(w, e->tile_len);
+
+	for (; slot < slot_end; slot += slot_step) {
+		sieve_window_lpf_carried_fastdiv(e, &e->tab[w->node], base + 1, e->tile_len, w->off, &w->br, w->residual, w->lpf);
+		sweep_tile_collect(base + 1, e->tile_len, w->residual, w->lpf, &es->sweep_tiles[slot]);
+		worker_advance_offsets(w, base + 1);
+		worker_count_tile(w, base + 1, e->tile_len);
+		base += e->step;
+	}
+}
+
+// Verify epochs: the open rows lane, lane + threads, ... of the file. A row starts with a
+// window of win values and doubles it while the run continues (off[] is set up per
+// window); a run that reaches the prime bound stays open for a pass with a larger one.
+static void worker_run_verify_epoch(WorkerCtx* w, EpochSlot* es, uint32_t lane) {
+	JobSystem* js = w->js;
+	const Epoch* e = &js->epoch;
+
+	for (uint32_t r = lane; r < es->verify_count; r += js->thread_count) {
+		VerifyRow* row = &es->verify_rows[r];
+		if (!row->open) continue;
+
+		PlateauRun pr = { 0, UINT32_MAX };
+		uint64_t base = row->m + 1;
+		uint32_t n = (row->win < e->k) ? row->win : e->k;
+		int ended;
+		for (;;) {
+			ensure_worker_buffers(w, n);
+			ensure_worker_lpf(w, n);
+			worker_init_offsets(w, base);
+
+			ended = scan_window_plateau_carried_fastdiv(e, &e->tab[w->node], base, n, w->off, &w->br, w->residual, w->lpf, &pr);
+			worker_advance_offsets(w, base);
+			worker_count_tile(w, base, n);
+			if (ended || pr.z >= e->k) break;
+
+			base += n;
+			n = (pr.z < e->k - pr.z) ? pr.z : e->k - pr.z;
+		}
+		row->len = pr.z;
+		row->open = !ended;
+
+		// a run shorter than k ended in the first window, which is still in residual[]
+		row->bad = 0;
+		for (uint32_t i = 0; row->len < row->k && i < row->k; ++i) {
+			if (w->residual[i] != 1) continue;
+			if (row->m + 1 + i == 1 || w->lpf[i] <= row->k) { row->bad = i + 1; break; }
+		}
+	}
+}
+
+static void worker_main(WorkerCtx* w) {
+	JobSystem* js = w->js;
+	uint64_t t0 = sys_now_us();
+
+	for (;;) {
+		uint32_t key = 0, lane = 0;
+		jobq_wait(&js->jobs, &key, &lane);
+		uint64_t t1 = sys_now_us();
+		w->stat[STAT_IDLE_US] += t1 - t0;
+		store_u64(&js->stats.pub[(size_t)w->tid * STAT_COUNT + STAT_IDLE_US], w->stat[STAT_IDLE_US]);
+		t0 = t1;
+
+		if (key == KEY_STOP) break;
+
+		if (key >= KEY_START && key < KEY_START + EPOCH_DEPTH) {
+			// The packet, not the thread, owns the stride: a fast thread may dequeue two
+			// lanes of one epoch, and every lane must still be scanned exactly once.
+			EpochSlot* es = &js->epoch.slot[key - KEY_START];
+			if      (js->epoch.mode == EPOCH_TASK)      js->epoch.task(w, js->epoch.task_arg, lane);
+			else if (js->epoch.mode == EPOCH_VERIFY)    worker_run_verify_epoch(w, es, lane);
+			else if (js->epoch.schedule == SCHED_STEAL) worker_run_steal_epoch(w, es, lane);
+			else if (js->epoch.mode == EPOCH_SWEEP)     worker_run_sweep_epoch(w, es, lane);
+			else                                        worker_run_find_epoch(w, es, lane);
+			t0 = sys_now_us();
+			w->stat[STAT_BUSY_US] += t0 - t1;
+			worker_publish_stats(w);
+			worker_epoch_done(es);
+		}
+	}
+}
+
+// ------------------------------------------------------------
+// Epoch orchestration (contiguous batch scan)
+// ------------------------------------------------------------
+
+static uint64_t epoch_wait(JobSystem* js, EpochSlot* es);
+
+// Waits for every batch still in flight.
+static void epoch_drain(JobSystem* js) {
+	for (uint32_t i = 0; i < EPOCH_DEPTH; ++i)
+		if (js->epoch.slot[i].busy) epoch_wait(js, &js->epoch.slot[i]);
+}
+
+// Posts the lanes of batch [start_m, end_m] into es while other slots may still run.
+// e->k, tile_len, step and the math arrays are fixed per k by the caller.
+static void epoch_begin(JobSystem* js, EpochSlot* es, uint64_t start_m, uint64_t end_m) {
+	Epoch* e = &js->epoch;
+	uint32_t tile_len = e->tile_len;
+
+	if (e->kernel == KERNEL_LOG) {
+		// the scale is shared by all slots: only change it with nothing in flight
+		uint64_t x_hi = end_m + (uint64_t)tile_len * js->thread_count + e->k;
+		if (x_hi < end_m) x_hi = UINT64_MAX;
+		if (log_scale_for(x_hi) != e->log_scale) {
+			epoch_drain(js);
+			epoch_update_log_scale(e, x_hi);
+		}
+	}
+
+	es->start_m = start_m;
+	es->end_m = end_m;
+
+	uint64_t tiles = (end_m - start_m) / tile_len + 1;
+	uint64_t per_lane = (tiles + js->thread_count - 1) / js->thread_count;
+	es->lane_span = per_lane * (uint64_t)tile_len;
+	es->tile_count = (uint32_t)tiles;
+
+	if (e->schedule == SCHED_STEAL) {
+		for (uint32_t i = 0; i < js->thread_count; ++i) {
+			uint64_t lo = (uint64_t)i * per_lane, hi = lo + per_lane;
+			if (lo > tiles) lo = tiles;
+			if (hi > tiles) hi = tiles;
+			store_u64(&es->steal[i], steal_pack((uint32_t)lo, (uint32_t)hi));
+		}
+	}
+
+	event_reset(&es->evt_done);
+	store_u32(&es->active_workers, js->thread_count);
+	es->busy = 1;
+
+	uint32_t key = KEY_START + (uint32_t)(es - e->slot);
+	for (uint32_t i = 0; i < js->thread_count; ++i)
+		jobq_post(&js->jobs, key, i);
+}
+
+static uint64_t epoch_wait(JobSystem* js, EpochSlot* es) {
+	uint64_t t0 = sys_now_us();
+	event_wait(&es->evt_done);
+	js->stats.wait_us += sys_now_us() - t0;
+	es->busy = 0;
+	return load_u64(&js->epoch.best_m);
+}
+
+// SCHED_CONTIG find batches: walk the lanes in order with the clear run g entering each
+// one. A run that reaches k inside a lane's head starts before anything that lane (or any
+// later lane) found; g leaves the last lane as the next batch's carry_gap. Batches must be
+// stitched in order.
+static uint64_t epoch_stitch_lanes(JobSystem* js, const EpochSlot* es, uint64_t best) {
+	Epoch* e = &js->epoch;
+	uint64_t g = e->carry_gap;
+
+	for (uint32_t i = 0; i < js->thread_count; ++i) {
+		const LaneRun* r = &es->lane_runs[i];
+		if (g + r->head >= e->k) {
+			uint64_t m = epoch_lane_base(e, es, i) - g;
+			if (m < best) {
+				try_set_best(js, m);   // cuts the batch still in flight short
+				best = m;
+			}
+			return best;
+		}
+		if (!r->complete) return best;
+		g = (r->head == r->len) ? g + r->len : r->tail;
+	}
+
+	e->carry_gap = g;
+	return best;
+}
+
+#ifdef MK_NO_MAIN
+// EPOCH_TASK: fn(w, arg, lane) on every lane of one epoch; returns once all are done.
+static void epoch_run_task(JobSystem* js, EpochTaskFn fn, void* arg) {
+	Epoch* e = &js->epoch;
+	e->mode = EPOCH_TASK;
+	e->task = fn;
+	e->task_arg = arg;
+	e->tile_len = 1;   // epoch_begin sizes the (unused) lanes from it
+	epoch_begin(js, &e->slot[0], 0, 0);
+	epoch_wait(js, &e->slot[0]);
+}
+#endif
+
+static uint64_t safe_add_u64(uint64_t a, uint64_t b) {
+	uint64_t c = a + b;
+	return (c < a) ? UINT64_MAX : c;
+}
+
+// ------------------------------------------------------------
+// Run statistics: heartbeat, per-k and final reports (main thread, stderr)
+// ------------------------------------------------------------
+//
+// A report covers the time since a StatMark and moves the mark to now. Rates per worker
+// are values over that worker's busy time; the total rate is values over wall time, and
+// wait is the main thread's time in epoch_wait (the barrier the pipeline did not hide).
+//
+
+static void stats_init(Stats* st, uint32_t threads) {
+	size_t n = (size_t)threads * STAT_COUNT;
+	st->pub = (shared_u64*)calloc(n, sizeof(shared_u64));
+	st->cur = (uint64_t*)calloc(n, sizeof(uint64_t));
+	st->beat.row = (uint64_t*)calloc(n, sizeof(uint64_t));
+	st->k.row = (uint64_t*)calloc(n, sizeof(uint64_t));
+	st->run.row = (uint64_t*)calloc(n, sizeof(uint64_t));
+	if (!st->pub || !st->cur || !st->beat.row || !st->k.row || !st->run.row) {
+		fprintf(stderr, "calloc failed for stats (threads=%u)\n", threads);
+		exit(2);
+	}
+}
+
+static void stats_free(Stats* st) {
+	free((void*)st->pub);
+	free(st->cur);
+	free(st->beat.row);
+	free(st->k.row);
+	free(st->run.row);
+}
+
+static void stats_mark(JobSystem* js, StatMark* mk) {
+	size_t n = (size_t)js->thread_count * STAT_COUNT;
+	mk->us = sys_now_us();
+	mk->wait_us = js->stats.wait_us;
+	for (size_t i = 0; i < n; ++i) mk->row[i] = load_u64(&js->stats.pub[i]);
+}
+
+// ev: "progress", "k" (one k done) or "total" (k == 0, with one line per worker).
+static void stats_report(JobSystem* js, const char* ev, uint32_t k, uint64_t m, StatMark* since) {
+	Stats* st = &js->stats;
+	uint32_t n = js->thread_count;
+	uint64_t now = sys_now_us();
+	double wall = (now > since->us) ? (double)(now - since->us) : 1.0;
+	double wait_ms = (double)(st->wait_us - since->wait_us) / 1000.0;
+
+	uint64_t sum[STAT_COUNT] = { 0 };
+	double rmin = -1.0;   // slowest worker that ran in the window
+	for (uint32_t t = 0; t < n; ++t) {
+		uint64_t* c = st->cur + (size_t)t * STAT_COUNT;
+		const uint64_t* o = since->row + (size_t)t * STAT_COUNT;
+		for (uint32_t j = 0; j < STAT_COUNT; ++j) {
+			c[j] = load_u64(&st->pub[(size_t)t * STAT_COUNT + j]) - o[j];
+			sum[j] += c[j];
+		}
+		double r = (double)c[STAT_VALUES] / (double)c[STAT_BUSY_US];
+		if (c[STAT_BUSY_US] && (rmin < 0.0 || r < rmin)) rmin = r;
+	}
+	if (rmin < 0.0) rmin = 0.0;
+	char mb[40];
+	const char* ms = u128_str(mb, js->epoch.origin + m);
+	double rate = (double)sum[STAT_VALUES] / wall;   // values per us = M values/s
+	double per = sum[STAT_BUSY_US] ? (double)sum[STAT_VALUES] / (double)sum[STAT_BUSY_US] : 0.0;
+	// idle gaps are stored when a job starts, so a short window can see one that began earlier
+	double idle = 100.0 * (double)sum[STAT_IDLE_US] / (wall * n);
+	if (idle > 100.0) idle = 100.0;
+
+	if (st->json) {
+		fprintf(stderr, "{\"ev\":\"%s\"", ev);
+		if (k) fprintf(stderr, ",\"k\":%u,\"m\":%s", k, ms);
+		fprintf(stderr, ",\"s\":%.3f,\"tiles\":%llu,\"values\":%llu,\"mvps\":%.2f,\"wait_ms\":%.1f,\"idle_pct\":%.1f",
+			wall / 1e6, (unsigned long long)sum[STAT_TILES], (unsigned long long)sum[STAT_VALUES], rate, wait_ms, idle);
+#if STATS_HOT
+		fprintf(stderr, ",\"hits\":%llu,\"fd_fix\":%llu", (unsigned long long)sum[STAT_HITS], (unsigned long long)sum[STAT_FD_FIX]);
+#else
+		fprintf(stderr, ",\"hits\":null,\"fd_fix\":null");
+#endif
+		fprintf(stderr, ",\"worker_mvps\":[");
+		for (uint32_t t = 0; t < n; ++t) {
+			const uint64_t* c = st->cur + (size_t)t * STAT_COUNT;
+			fprintf(stderr, "%s%.2f", t ? "," : "", c[STAT_BUSY_US] ? (double)c[STAT_VALUES] / (double)c[STAT_BUSY_US] : 0.0);
+		}
+		fprintf(stderr, "]}\n");
+	}
+	else {
+		const char* label = (strcmp(ev, "progress") == 0) ? ev : "stats";
+		if (k) fprintf(stderr, "; %s k=%u m=%s:", label, k, ms);
+		else   fprintf(stderr, "; %s total:", label);
+		fprintf(stderr, " %.2f s, %llu tiles, %.1f Mv/s, %.1f Mv/s per busy worker (min %.1f), wait %.1f ms, idle %.0f%%",
+			wall / 1e6, (unsigned long long)sum[STAT_TILES], rate, per, rmin, wait_ms, idle);
+#if STATS_HOT
+		fprintf(stderr, ", %llu hits, %llu fd fixes", (unsigned long long)sum[STAT_HITS], (unsigned long long)sum[STAT_FD_FIX]);
+#endif
+		fprintf(stderr, "\n");
+		for (uint32_t t = 0; !k && t < n; ++t) {
+			const uint64_t* c = st->cur + (size_t)t * STAT_COUNT;
+			double wi = 100.0 * (double)c[STAT_IDLE_US] / wall;
+			fprintf(stderr, "; worker %u: %llu tiles, %.1f Mv/s, idle %.0f%%\n", t, (unsigned long long)c[STAT_TILES],
+				c[STAT_BUSY_US] ? (double)c[STAT_VALUES] / (double)c[STAT_BUSY_US] : 0.0, wi > 100.0 ? 100.0 : wi);
+		}
+	}
+
+	for (size_t i = 0; i < (size_t)n * STAT_COUNT; ++i) since->row[i] += st->cur[i];
+	since->us = now;
+	since->wait_us = st->wait_us;
+}
+
+// Heartbeat at a batch boundary; m is the confirmed frontier.
+static void stats_tick(JobSystem* js, uint32_t k, uint64_t m) {
+	Stats* st = &js->stats;
+	if (st->on && st->every_ms && sys_now_us() - st->beat.us >= (uint64_t)st->every_ms * 1000u)
+		stats_report(js, "progress", k, m, &st->beat);
+}
+
+// ------------------------------------------------------------
+// Checkpoint / resume (find mode)
+// ------------------------------------------------------------
+//
+// The frontier is (k, cur): m(k') is known for every k' < k and every m < cur fails k.
+// That does not depend on threads, tiles or schedule, so a run may resume with other
+// settings. The file is written to <path>.tmp, synced, and renamed over the old one, so
+// an interruption leaves either the previous or the new checkpoint.
+//
+// Layout (native endian): CkptHeader, then count (k, m) u64 pairs, the plateau points.
+//
+
+#define CKPT_MAGIC    0x31504B43u   // "CKP1"
+#ifndef CKPT_EVERY_MS
+#define CKPT_EVERY_MS 60000u
+#endif
+
+typedef struct CkptHeader {
+	uint32_t magic;
+	uint32_t k;         // k being searched
+	uint64_t cur;       // every m < cur fails k
+	uint64_t count;     // plateau points that follow
+} CkptHeader;
+
+typedef struct Checkpoint {
+	const char* path;   // NULL: off
+	const char* bin;    // --bin: plateau file written from pts at the end (NULL: off)
+	uint64_t  last_ms;  // time of the last write
+	uint32_t  k;
+	uint64_t  cur;
+	uint64_t* pts;      // [2 * count]: k, m of each plateau point printed
+	uint32_t  count;
+	uint32_t  cap;
+} Checkpoint;
+
+static void checkpoint_push(Checkpoint* ck, uint32_t k, uint64_t m) {
+	if (!ck->path && !ck->bin) return;
+	if (ck->count == ck->cap) {
+		uint32_t cap = ck->cap ? ck->cap * 2 : 256;
+		uint64_t* pts = (uint64_t*)realloc(ck->pts, (size_t)cap * 2 * sizeof(uint64_t));
+		if (!pts) {
+			fprintf(stderr, "realloc failed for checkpoint points (cap=%u)\n", cap);
+			exit(2);
+		}
+		ck->pts = pts;
+		ck->cap = cap;
+	}
+	ck->pts[2 * ck->count] = k;
+	ck->pts[2 * ck->count + 1] = m;
+	++ck->count;
+}
+
+static void checkpoint_save(Checkpoint* ck) {
+	size_t n = strlen(ck->path);
+	char* tmp = (char*)malloc(n + 5);
+	if (!tmp) {
+		fprintf(stderr, "malloc failed for checkpoint path\n");
+		exit(2);
+	}
+	memcpy(tmp, ck->path, n);
+	memcpy(tmp + n, ".tmp", 5);
+
+	CkptHeader h = { CKPT_MAGIC, ck->k, ck->cur, ck->count };
+	FILE* f = fopen(tmp, "wb");
+	int ok = (f != NULL);
+	if (ok) {
+		ok = fwrite(&h, sizeof(h), 1, f) == 1 &&
+		     (ck->count == 0 || fwrite(ck->pts, 2 * sizeof(uint64_t), ck->count, f) == ck->count);
+		if (ok) ok = sys_commit_file(f, tmp, ck->path);
+		else    fclose(f);
+	}
+	// not fatal: the previous checkpoint is still in place
+	if (!ok) fprintf(stderr, "checkpoint write failed: %s\n", ck->path);
+
+	free(tmp);
+	ck->last_ms = sys_now_ms();
+}
+
+static int checkpoint_load(Checkpoint* ck) {
+	FILE* f = fopen(ck->path, "rb");
+	if (!f) return 0;
+
+	CkptHeader h;
+	int ok = fread(&h, sizeof(h), 1, f) == 1 && h.magic == CKPT_MAGIC && h.count <= UINT32_MAX;
+	for (uint64_t i = 0; ok && i < h.count; ++i) {
+		uint64_t pt[2];
+		ok = fread(pt, sizeof(pt), 1, f) == 1;
+		if (ok) checkpoint_push(ck, (uint32_t)pt[0], pt[1]);
+	}
+	fclose(f);
+
+	ck->k = h.k;
+	ck->cur = h.cur;
+	return ok;
+}
+
+// The frontier moved; written at most every CKPT_EVERY_MS. ck may be NULL (nodes).
+static void checkpoint_progress(Checkpoint* ck, uint32_t k, uint64_t cur) {
+	if (!ck || !ck->path) return;
+	ck->k = k;
+	ck->cur = cur;
+	if (sys_now_ms() - ck->last_ms >= CKPT_EVERY_MS) checkpoint_save(ck);
+}
+
+// Loads ck, reprints its plateau points with k <= K, and sets the frontier to go on from.
+static int checkpoint_resume(Checkpoint* ck, uint32_t K, uint32_t* k0, uint64_t* cur, uint64_t* last_print) {
+	if (!checkpoint_load(ck)) {
+		fprintf(stderr, "cannot resume from checkpoint: %s\n", ck->path);
+		return 0;
+	}
+	for (uint32_t i = 0; i < ck->count && ck->pts[2 * i] <= K; ++i) {
+		printf("%u, %llu\n", (uint32_t)ck->pts[2 * i], (unsigned long long)ck->pts[2 * i + 1]);
+		*last_print = ck->pts[2 * i + 1];
+	}
+	*k0 = ck->k;
+	*cur = ck->cur;
+	fprintf(stderr, "; resume: k=%u, m >= %llu\n", *k0, (unsigned long long)*cur);
+	return 1;
+}
+
+// ------------------------------------------------------------
+// Plateau file (--bin): fixed-width records for the tools (kmp.py)
+// ------------------------------------------------------------
+//
+// Layout (little endian, packed):
+//   header   magic "KMP1", flags, count, index_shift, reserved, index_off (32 bytes)
+//   records  count x (u32 k, u64 m), sorted by m (plateau points: by k as well)
+//   index    ceil(count / 2^index_shift) u64, the m of every 2^index_shift-th record,
+//            at index_off (8-byte aligned)
+// k(n) is the k of the last record with m <= n: a search over the index, then over one
+// block of records. KMP_DENSE marks sampled step functions (n, k(n)) instead of plateau
+// points; the engine writes plateau points.
+//
+
+#define KMP_MAGIC       0x31504D4Bu   // "KMP1"
+#define KMP_HEADER      32u
+#define KMP_RECORD      12u
+#define KMP_INDEX_SHIFT 10u
+#define KMP_DENSE       1u
+
+static void kmp_put(uint8_t* b, uint64_t v, uint32_t bytes) {
+	for (uint32_t i = 0; i < bytes; ++i) b[i] = (uint8_t)(v >> (8 * i));
+}
+
+// ck->bin from ck->pts, through <bin>.tmp and a rename like the checkpoint.
+static int plateau_bin_save(const Checkpoint* ck) {
+	uint64_t n = ck->count;
+	uint64_t blocks = (n + (1u << KMP_INDEX_SHIFT) - 1) >> KMP_INDEX_SHIFT;
+	uint64_t index_off = (KMP_HEADER + n * KMP_RECORD + 7) & ~7ull;
+	size_t bytes = (size_t)(index_off + blocks * 8);
+
+	size_t len = strlen(ck->bin);
+	char* tmp = (char*)malloc(len + 5);
+	uint8_t* b = (uint8_t*)calloc(bytes, 1);
+	if (!tmp || !b) {
+		fprintf(stderr, "alloc failed for plateau file (count=%llu)\n", (unsigned long long)n);
+		exit(2);
+	}
+	memcpy(tmp, ck->bin, len);
+	memcpy(tmp + len, ".tmp", 5);
+
+	kmp_put(b, KMP_MAGIC, 4);
+	kmp_put(b + 4, 0, 4);
+	kmp_put(b + 8, n, 8);
+	kmp_put(b + 16, KMP_INDEX_SHIFT, 4);
+	kmp_put(b + 24, index_off, 8);
+	for (uint64_t i = 0; i < n; ++i) {
+		uint8_t* r = b + KMP_HEADER + i * KMP_RECORD;
+		kmp_put(r, ck->pts[2 * i], 4);
+		kmp_put(r + 4, ck->pts[2 * i + 1], 8);
+		if ((i & ((1u << KMP_INDEX_SHIFT) - 1)) == 0)
+			kmp_put(b + index_off + (i >> KMP_INDEX_SHIFT) * 8, ck->pts[2 * i + 1], 8);
+	}
+
+	FILE* f = fopen(tmp, "wb");
+	int ok = (f != NULL);
+	if (ok) {
+		ok = fwrite(b, 1, bytes, f) == bytes;
+		if (ok) ok = sys_commit_file(f, tmp, ck->bin);
+		else    fclose(f);
+	}
+	if (!ok) fprintf(stderr, "plateau file write failed: %s\n", ck->bin);
+
+	free(b);
+	free(tmp);
+	return ok;
+}
+
+// Per-k tables for find epochs (find_m_for_k, or one node's ranges of k).
+static void find_begin_k(JobSystem* js, uint32_t k, uint32_t tile_len) {
+	Epoch* e = &js->epoch;
+
+	e->mode = EPOCH_FIND_M;
+
+	// Per-k view of the prime tables (step depends on tile_len and thread_count).
+	e->k = k;
+	e->tile_len = tile_len;
+	e->step = epoch_step(js, tile_len);
+	epoch_prepare_math(js);
+
+	if (e->schedule == SCHED_CONTIG) {
+		for (uint32_t i = 0; i < EPOCH_DEPTH; ++i) {
+			e->slot[i].lane_runs = (LaneRun*)calloc(js->thread_count, sizeof(LaneRun));
+			if (!e->slot[i].lane_runs) {
+				fprintf(stderr, "calloc failed for lane runs (count=%u)\n", js->thread_count);
+				exit(2);
+			}
+		}
+	}
+}
+
+static void find_end_k(JobSystem* js) {
+	Epoch* e = &js->epoch;
+	epoch_free_math(e);
+	for (uint32_t i = 0; i < EPOCH_DEPTH; ++i) {
+		free(e->slot[i].lane_runs);
+		e->slot[i].lane_runs = NULL;
+	}
+}
+
+typedef struct NodeLink NodeLink;
+static void node_sync(JobSystem* js, NodeLink* link);
+
+// Scan starts start_m..stop_m (none above limit) in contiguous batches, EPOCH_DEPTH of
+// them in flight. The first batch (in order) that holds a solution yields the minimum; a
+// find in a later batch only shrinks end_limit until every earlier batch is confirmed
+// empty. Returns UINT64_MAX when the range (up to the limit) holds none.
+static uint64_t find_scan(JobSystem* js, uint64_t start_m, uint64_t stop_m, uint64_t limit, uint64_t batch_tiles, Checkpoint* ck, NodeLink* link) {
+	Epoch* e = &js->epoch;
+	int contig = (e->schedule == SCHED_CONTIG);
+
+	e->carry_gap = 0;
+	store_u64(&e->best_m, UINT64_MAX);
+	store_u64(&e->end_limit, limit);
+
+	uint64_t span = (uint64_t)e->tile_len * batch_tiles;
+	if (span == 0) span = e->tile_len;
+
+	uint64_t cur = start_m;   // next batch to begin
+	uint32_t begun = 0, done = 0;
+	int more = 1;
+	uint64_t best = UINT64_MAX;
+
+	for (;;) {
+		while (more && begun - done < EPOCH_DEPTH && cur <= load_u64(&e->end_limit)) {
+			uint64_t end = safe_add_u64(cur, span - 1);
+			if (end >= stop_m) { end = stop_m; more = 0; }
+			epoch_begin(js, &e->slot[begun % EPOCH_DEPTH], cur, end);
+			++begun;
+			cur = end + 1;
+		}
+		if (done == begun) break;   // nothing up to stop_m / the limit
+
+		EpochSlot* es = &e->slot[done % EPOCH_DEPTH];
+		best = epoch_wait(js, es);
+		++done;
+		if (contig) best = epoch_stitch_lanes(js, es, best);
+		if (best <= es->end_m) break;   // every batch before this one came up empty
+
+		// with --contig a run may still start inside the carried clear tail
+		uint64_t front = es->end_m + 1 - (contig ? e->carry_gap : 0);
+		checkpoint_progress(ck, e->k, front);
+		stats_tick(js, e->k, front);
+		if (link) node_sync(js, link);
+	}
+
+	epoch_drain(js);
+	return best;
+}
+
+// Find minimal m(k) >= start_m on this machine.
+static uint64_t find_m_for_k(JobSystem* js, uint32_t k, uint64_t start_m, uint32_t tile_len, uint64_t batch_tiles, Checkpoint* ck) {
+	find_begin_k(js, k, tile_len);
+	uint64_t best = find_scan(js, start_m, UINT64_MAX, UINT64_MAX, batch_tiles, ck, NULL);
+	find_end_k(js);
+	return best;
+}
+
+#ifndef WIDE_REBASE_AT
+#define WIDE_REBASE_AT (1ull << 62)   // local find: frontier position that moves the origin up
+#endif
+
+// Move the origin up by `by` between two k (nothing in flight): positions restart near 0,
+// and from here on every window goes through the wide kernel.
+static void find_rebase(JobSystem* js, uint64_t by) {
+	Epoch* e = &js->epoch;
+	char b[40];
+
+	if (!e->origin && (e->kernel != KERNEL_EXACT || e->bucket))
+		fprintf(stderr, "; wide: --log, --lean and --bucket stop here; the exact wide kernel takes over\n");
+	e->kernel = KERNEL_EXACT;
+	e->origin += by;
+	++e->math_gen;   // off[] were positioned for the old origin
+	fprintf(stderr, "; wide: origin %s\n", u128_str(b, e->origin));
+}
+
+// ------------------------------------------------------------
+// Skip index: what the values after m(k) say about k+1, k+2, ...
+// ------------------------------------------------------------
+//
+// m(k) >= m(k-1), since a block valid for k is valid for k-1. Every value in the clear
+// run from m+1 has a prime factor > k0 (the k that found m); it turns bad for a later k
+// only if it is K-smooth with largest prime factor q <= k. The index keeps the run length
+// (up to K+1) and those (offset, q) pairs, so for each later k:
+//   clear(k) >= k:  m(k) = m, no epoch needed
+//   otherwise:      value m + clear(k) + 1 is bad, and a block over it cannot be valid;
+//                   a block inside the run would need clear(k) >= k: m(k) > m + clear(k)
+//
+
+typedef struct SkipIndex {
+	uint64_t  m;        // last m(k) found by a search
+	uint32_t  len;      // clear values from m+1 at the k that found m (capped at K+1)
+	uint32_t  count;
+	uint32_t* at;       // [count] offset (1-based) of a K-smooth value inside the run
+	uint32_t* q;        // [count] its largest prime factor
+	PrimeList primes;   // <= K
+	uint32_t  K;
+	uint64_t* res;      // [K+1] scratch
+	uint32_t* lpf;      // [K+1] scratch
+} SkipIndex;
+
+static void skip_init(SkipIndex* sk, uint32_t K) {
+	memset(sk, 0, sizeof(*sk));
+	sk->K = K;
+	sk->primes = primes_upto(K);
+	size_t n = (size_t)K + 1;
+	sk->at = (uint32_t*)malloc(n * sizeof(uint32_t));
+	sk->q = (uint32_t*)malloc(n * sizeof(uint32_t));
+	sk->res = (uint64_t*)malloc(n * sizeof(uint64_t));
+	sk->lpf = (uint32_t*)malloc(n * sizeof(uint32_t));
+	if (!sk->at || !sk->q || !sk->res || !sk->lpf) {
+		fprintf(stderr, "malloc failed for skip index (K=%u)\n", K);
+		exit(2);
+	}
+}
+
+static void skip_free(SkipIndex* sk) {
+	free(sk->at);
+	free(sk->q);
+	free(sk->res);
+	free(sk->lpf);
+	primes_free(&sk->primes);
+}
+
+// Rebuild for m = m(k): strip primes <= K from the K+1 values after m (plain division;
+// this runs once per search, not per tile).
+static void skip_build(SkipIndex* sk, uint64_t m, uint32_t k) {
+	uint32_t n = sk->K + 1;
+	for (uint32_t i = 0; i < n; ++i) {
+		sk->res[i] = m + 1 + i;
+		sk->lpf[i] = 1;   // 1 for the value 1 itself
+	}
+	for (uint32_t pi = 0; pi < sk->primes.count; ++pi) {
+		uint32_t p = sk->primes.p[pi];
+		uint32_t r = (uint32_t)((m + 1) % p);
+		for (uint32_t i = r ? p - r : 0; i < n; i += p) {
+			do sk->res[i] /= p; while (sk->res[i] % p == 0);
+			sk->lpf[i] = p;
+		}
+	}
+
+	sk->m = m;
+	sk->len = 0;
+	sk->count = 0;
+	for (uint32_t i = 0; i < n; ++i) {
+		int smooth = (sk->res[i] == 1);
+		if (smooth && sk->lpf[i] <= k) break;
+		if (smooth) {
+			sk->at[sk->count] = i + 1;
+			sk->q[sk->count] = sk->lpf[i];
+			++sk->count;
+		}
+		++sk->len;
+	}
+}
+
+// Leading clear values after sk->m once primes <= k count.
+static uint32_t skip_clear(const SkipIndex* sk, uint32_t k) {
+	for (uint32_t j = 0; j < sk->count; ++j)
+		if (sk->q[j] <= k) return sk->at[j] - 1;
+	return sk->len;
+}
+
+// ------------------------------------------------------------
+// Distributed find: a coordinator (--serve) leases m-ranges of k to nodes (--connect)
+// ------------------------------------------------------------
+//
+// One TCP connection per node, ASCII lines, driven by the node:
+//   GET            -> RANGE k a b limit | WAIT | DONE
+//   LIMIT k a b    -> LIMIT limit | STOP        (between the node's local batches)
+//   RESULT k a b m (or '-' for none; no reply, the node goes on with GET)
+// A node decides the starts a..b with its own threads and settings. Any m it reports is
+// a solution, so the coordinator keeps min(best) as try_set_best does and hands limit =
+// best-1 out with every RANGE and LIMIT: the node's end_limit drops with it and work
+// above is abandoned. m(k) is final once every range with a <= limit is done. A range
+// whose node drops the connection, or stays silent for the lease, is issued again; the
+// later of two results for it is ignored.
+//
+
+#define NET_LINE       128
+#define COORD_MAX_CONN 250   // below FD_SETSIZE
+
+typedef struct NetConn {
+	SysSock  s;
+	uint32_t len;
+	char     buf[512];
+} NetConn;
+
+// Listening (host NULL) or connected TCP socket for host:port.
+static SysSock net_open(const char* host, const char* port) {
+	struct addrinfo hints, *res = NULL;
+	memset(&hints, 0, sizeof(hints));
+	hints.ai_family = AF_UNSPEC;
+	hints.ai_socktype = SOCK_STREAM;
+	hints.ai_flags = host ? 0 : AI_PASSIVE;
+	if (getaddrinfo(host, port, &hints, &res) != 0) return SYS_SOCK_BAD;
+
+	SysSock s = SYS_SOCK_BAD;
+	for (struct addrinfo* ai = res; ai; ai = ai->ai_next) {
+		s = socket(ai->ai_family, ai->ai_socktype, ai->ai_protocol);
+		if (s == SYS_SOCK_BAD) continue;
+
+		int one = 1;
+		if (!host) {
+			setsockopt(s, SOL_SOCKET, SO_REUSEADDR, (const char*)&one, sizeof(one));
+			if (bind(s, ai->ai_addr, (int)ai->ai_addrlen) == 0 && listen(s, 64) == 0) break;
+		}
+		else {
+			setsockopt(s, IPPROTO_TCP, TCP_NODELAY, (const char*)&one, sizeof(one));
+			if (connect(s, ai->ai_addr, (int)ai->ai_addrlen) == 0) break;
+		}
+		sys_sock_close(s);
+		s = SYS_SOCK_BAD;
+	}
+	freeaddrinfo(res);
+	return s;
+}
+
+static int net_send_line(NetConn* c, const char* line) {
+	size_t n = strlen(line);
+	while (n) {
+		int r = send(c->s, line, (int)n, 0);
+		if (r <= 0) return 0;
+		line += r;
+		n -= (size_t)r;
+	}
+	return 1;
+}
+
+// One recv() into the buffer; 0 on EOF, error, or a line too long to buffer.
+static int net_fill(NetConn* c) {
+	if (c->len == sizeof(c->buf)) return 0;
+	int r = recv(c->s, c->buf + c->len, (int)(sizeof(c->buf) - c->len), 0);
+	if (r <= 0) return 0;
+	c->len += (uint32_t)r;
+	return 1;
+}
+
+// Next buffered line, without its newline, into out[NET_LINE].
+static int net_take_line(NetConn* c, char* out) {
+	char* nl = (char*)memchr(c->buf, '\n', c->len);
+	if (!nl) return 0;
+
+	uint32_t n = (uint32_t)(nl - c->buf);
+	uint32_t m = (n < NET_LINE - 1) ? n : NET_LINE - 1;
+	memcpy(out, c->buf, m);
+	out[m] = 0;
+	if (m && out[m - 1] == '\r') out[m - 1] = 0;
+
+	c->len -= n + 1;
+	memmove(c->buf, nl + 1, c->len);
+	return 1;
+}
+
+static int net_recv_line(NetConn* c, char* out) {
+	while (!net_take_line(c, out))
+		if (!net_fill(c)) return 0;
+	return 1;
+}
+
+// ---- node
+
+struct NodeLink {
+	NetConn  c;
+	uint32_t k;         // range being scanned
+	uint64_t a, b;
+	int      lost;      // coordinator gone: abandon the range
+};
+
+// Between local batches: renews the lease and pulls the coordinator's limit down.
+static void node_sync(JobSystem* js, NodeLink* link) {
+	char line[NET_LINE];
+	unsigned long long lim;
+
+	snprintf(line, sizeof(line), "LIMIT %u %llu %llu\n", link->k, (unsigned long long)link->a, (unsigned long long)link->b);
+	if (!net_send_line(&link->c, line) || !net_recv_line(&link->c, line)) link->lost = 1;
+
+	if (link->lost || strcmp(line, "STOP") == 0) lower_end_limit(js, 0);
+	else if (sscanf(line, "LIMIT %llu", &lim) == 1) lower_end_limit(js, lim);
+}
+
+static int node_run(JobSystem* js, const char* addr, uint32_t tile_len, uint64_t batch_tiles) {
+	char host[256];
+	const char* colon = strrchr(addr, ':');
+	size_t hl = colon ? (size_t)(colon - addr) : 0;
+	if (!colon || hl == 0 || hl >= sizeof(host)) {
+		fprintf(stderr, "--connect needs HOST:PORT, got %s\n", addr);
+		return 1;
+	}
+	memcpy(host, addr, hl);
+	host[hl] = 0;
+
+	NodeLink link;
+	memset(&link, 0, sizeof(link));
+	link.c.s = net_open(host, colon + 1);
+	if (link.c.s == SYS_SOCK_BAD) {
+		fprintf(stderr, "cannot connect to coordinator %s\n", addr);
+		return 1;
+	}
+
+	uint32_t have_k = 0;
+	char line[NET_LINE];
+
+	for (;;) {
+		if (!net_send_line(&link.c, "GET\n") || !net_recv_line(&link.c, line)) { link.lost = 1; break; }
+		if (strcmp(line, "DONE") == 0) break;
+		if (strcmp(line, "WAIT") == 0) { sys_sleep_ms(1000); continue; }
+
+		unsigned k;
+		unsigned long long a, b, lim;
+		if (sscanf(line, "RANGE %u %llu %llu %llu", &k, &a, &b, &lim) != 4 || k == 0 || a > b) {
+			fprintf(stderr, "unexpected reply from coordinator: %s\n", line);
+			break;
+		}
+		if (k != have_k) {
+			if (have_k) find_end_k(js);
+			find_begin_k(js, k, tile_len);
+			have_k = k;
+		}
+		link.k = k;
+		link.a = a;
+		link.b = b;
+
+		// contig lanes sieve values only through stop_m + 1: reach b + k so every start
+		// up to b is decided (a find past b is still a valid solution to report)
+		uint64_t stop = (js->epoch.schedule == SCHED_CONTIG) ? safe_add_u64(b, k - 1) : b;
+		uint64_t m = find_scan(js, a, stop, lim, batch_tiles, NULL, &link);
+		if (link.lost) break;
+
+		if (m == UINT64_MAX) snprintf(line, sizeof(line), "RESULT %u %llu %llu -\n", k, a, b);
+		else                 snprintf(line, sizeof(line), "RESULT %u %llu %llu %llu\n", k, a, b, (unsigned long long)m);
+		if (!net_send_line(&link.c, line)) { link.lost = 1; break; }
+	}
+
+	if (have_k) find_end_k(js);
+	sys_sock_close(link.c.s);
+	if (link.lost) fprintf(stderr, "; coordinator closed the connection\n");
+	return 0;
+}
+
+// ---- coordinator
+
+typedef struct CoordRange {
+	uint64_t a, b;
+	int32_t  owner;     // connection slot, -1: free to issue (again)
+	uint32_t done;
+	uint64_t renew_ms;  // last word from the owner
+} CoordRange;
+
+typedef struct Coord {
+	uint32_t k, K;
+	uint64_t span;      // starts per range
+	uint64_t next;      // first start of k not issued yet
+	uint64_t best;      // min m reported for k
+	uint64_t lease_ms;
+	uint64_t last_print;
+
+	CoordRange* r;      // issued ranges of k, by increasing a
+	uint32_t count, cap;
+	uint32_t first_open;// r[..first_open) are done
+	uint32_t spent;     // the last start below 2^64 has been issued for k
+	uint32_t exhausted; // ... and no range held a solution: the search stops
+
+	NetConn conn[COORD_MAX_CONN];   // s == SYS_SOCK_BAD: free slot
+} Coord;
+
+static uint64_t coord_limit(const Coord* c) {
+	return (c->best == UINT64_MAX || c->best == 0) ? c->best : c->best - 1;
+}
+
+static CoordRange* coord_find(Coord* c, uint64_t a, uint64_t b) {
+	uint32_t lo = 0, hi = c->count;
+	while (lo < hi) {
+		uint32_t mid = lo + (hi - lo) / 2;
+		if (c->r[mid].a < a) lo = mid + 1;
+		else                 hi = mid;
+	}
+	return (lo < c->count && c->r[lo].a == a && c->r[lo].b == b) ? &c->r[lo] : NULL;
+}
+
+// First free range with a <= limit, opening a new one at next if all are taken.
+static CoordRange* coord_take(Coord* c) {
+	uint64_t lim = coord_limit(c);
+
+	for (uint32_t i = c->first_open; i < c->count && c->r[i].a <= lim; ++i)
+		if (!c->r[i].done && c->r[i].owner < 0) return &c->r[i];
+	if (c->spent || c->next > lim) return NULL;
+
+	if (c->count == c->cap) {
+		uint32_t cap = c->cap ? c->cap * 2 : 1024;
+		CoordRange* r = (CoordRange*)realloc(c->r, (size_t)cap * sizeof(CoordRange));
+		if (!r) {
+			fprintf(stderr, "realloc failed for coordinator ranges (cap=%u)\n", cap);
+			exit(2);
+		}
+		c->r = r;
+		c->cap = cap;
+	}
+	CoordRange* r = &c->r[c->count++];
+	memset(r, 0, sizeof(*r));
+	r->a = c->next;
+	r->b = safe_add_u64(c->next, c->span - 1);
+	c->next = safe_add_u64(r->b, 1);
+	c->spent = (r->b == UINT64_MAX);
+	return r;
+}
+
+// Advance past done ranges; once nothing at or below the limit is open, m(k) is settled.
+static void coord_settle(Coord* c, Checkpoint* ck) {
+	while (c->first_open < c->count && c->r[c->first_open].done) ++c->first_open;
+
+	uint64_t lim = coord_limit(c);
+	uint64_t open_a = (c->first_open < c->count) ? c->r[c->first_open].a : c->next;
+	if (c->best == UINT64_MAX && c->spent && c->first_open == c->count) {
+		// node ranges are u64 positions; the wide kernel only runs in local find mode
+		fprintf(stderr, "; k=%u: no m below 2^64 in the distributed search; stopping\n", c->k);
+		c->exhausted = 1;
+		return;
+	}
+	if (c->best == UINT64_MAX || open_a <= lim) {
+		checkpoint_progress(ck, c->k, open_a);
+		return;
+	}
+
+	if (c->best != c->last_print) {
+		printf("%u, %llu\n", c->k, (unsigned long long)c->best);
+		c->last_print = c->best;
+		checkpoint_push(ck, c->k, c->best);
+	}
+
+	++c->k;
+	c->next = c->best;
+	c->best = UINT64_MAX;
+	c->count = 0;
+	c->first_open = 0;
+	c->spent = 0;
+	checkpoint_progress(ck, c->k, c->next);
+}
+
+static void coord_drop(Coord* c, uint32_t slot) {
+	sys_sock_close(c->conn[slot].s);
+	c->conn[slot].s = SYS_SOCK_BAD;
+	c->conn[slot].len = 0;
+	for (uint32_t i = c->first_open; i < c->count; ++i)
+		if (c->r[i].owner == (int32_t)slot) c->r[i].owner = -1;
+}
+
+static int coord_handle(Coord* c, uint32_t slot, const char* line, Checkpoint* ck) {
+	char out[NET_LINE];
+	unsigned k;
+	unsigned long long a, b;
+
+	if (strcmp(line, "GET") == 0) {
+		CoordRange* r = (c->k <= c->K) ? coord_take(c) : NULL;
+		if (r) {
+			r->owner = (int32_t)slot;
+			r->renew_ms = sys_now_ms();
+			snprintf(out, sizeof(out), "RANGE %u %llu %llu %llu\n", c->k,
+			         (unsigned long long)r->a, (unsigned long long)r->b, (unsigned long long)coord_limit(c));
+		}
+		else {
+			snprintf(out, sizeof(out), (c->k <= c->K) ? "WAIT\n" : "DONE\n");
+		}
+		return net_send_line(&c->conn[slot], out);
+	}
+
+	if (sscanf(line, "LIMIT %u %llu %llu", &k, &a, &b) == 3) {
+		CoordRange* r = (k == c->k) ? coord_find(c, a, b) : NULL;
+		if (r && !r->done) {
+			r->renew_ms = sys_now_ms();
+			snprintf(out, sizeof(out), "LIMIT %llu\n", (unsigned long long)coord_limit(c));
+		}
+		else {
+			snprintf(out, sizeof(out), "STOP\n");
+		}
+		return net_send_line(&c->conn[slot], out);
+	}
+
+	if (sscanf(line, "RESULT %u %llu %llu", &k, &a, &b) == 3) {
+		CoordRange* r = (k == c->k) ? coord_find(c, a, b) : NULL;
+		if (r && !r->done) {
+			const char* m = strrchr(line, ' ') + 1;
+			if (*m != '-') {
+				uint64_t v = strtoull(m, 0, 10);
+				if (v < c->best) c->best = v;
+			}
+			r->done = 1;
+			r->owner = -1;
+			coord_settle(c, ck);
+		}
+		return 1;
+	}
+
+	fprintf(stderr, "; ignoring node message: %s\n", line);
+	return 1;
+}
+
+static int coord_run(const char* port, uint32_t K, uint64_t span, uint64_t lease_ms, Checkpoint* ck, int resume) {
+	SysSock ls = net_open(NULL, port);
+	if (ls == SYS_SOCK_BAD) {
+		fprintf(stderr, "cannot listen on port %s\n", port);
+		return 1;
+	}
 
-	// k-smooth iff residual == 1
-	for (uint32_t i = 0; i < win_len; ++i) {
-		if (residual[i] == 1) bitset_set(bad_bits, i);
+	Coord* c = (Coord*)calloc(1, sizeof(Coord));
+	if (!c) {
+		fprintf(stderr, "calloc failed for coordinator\n");
+		exit(2);
 	}
-}
+	for (uint32_t i = 0; i < COORD_MAX_CONN; ++i) c->conn[i].s = SYS_SOCK_BAD;
+	c->k = 1;
+	c->K = K;
+	c->span = span ? span : 1;
+	c->best = UINT64_MAX;
+	c->lease_ms = lease_ms;
+	c->last_print = UINT64_MAX;
 
-static uint64_t scan_tile_find_m_carried_fastdiv(
-	const Epoch* e,
-	uint64_t m0,
-	uint32_t start_count,
-	uint32_t* off,          // in/out (advanced by one tile)
-	uint64_t* residual,
-	uint8_t* bad_bits
-) {
-	if (start_count == 0) return UINT64_MAX;
+	printf("; plateau points: k, m\n");
+	if (resume && !checkpoint_resume(ck, K, &c->k, &c->next, &c->last_print)) return 1;
+	ck->last_ms = sys_now_ms();
+	fprintf(stderr, "; coordinator on port %s, %llu starts per range\n", port, (unsigned long long)c->span);
+
+	while (c->k <= K && !c->exhausted) {
+		fd_set rd;
+		FD_ZERO(&rd);
+		FD_SET(ls, &rd);
+		SysSock top = ls;
+		for (uint32_t i = 0; i < COORD_MAX_CONN; ++i) {
+			if (c->conn[i].s == SYS_SOCK_BAD) continue;
+			FD_SET(c->conn[i].s, &rd);
+			if (c->conn[i].s > top) top = c->conn[i].s;
+		}
 
-	uint32_t k = e->k;
-	uint32_t win_len = start_count + k;
-	if (win_len < k) return UINT64_MAX;
+		struct timeval tv = { 1, 0 };
+		if (select((int)top + 1, &rd, NULL, NULL, &tv) < 0) continue;
+
+		if (FD_ISSET(ls, &rd)) {
+			SysSock s = accept(ls, NULL, NULL);
+			uint32_t i = 0;
+			while (i < COORD_MAX_CONN && c->conn[i].s != SYS_SOCK_BAD) ++i;
+			if (s != SYS_SOCK_BAD && i == COORD_MAX_CONN) sys_sock_close(s);
+			else if (s != SYS_SOCK_BAD) {
+				int one = 1;
+				setsockopt(s, IPPROTO_TCP, TCP_NODELAY, (const char*)&one, sizeof(one));
+				c->conn[i].s = s;
+				c->conn[i].len = 0;
+			}
+		}
 
-	sieve_window_bad_bits_carried_fastdiv(e, m0 + 1, start_count, off, residual, bad_bits);
+		for (uint32_t i = 0; i < COORD_MAX_CONN; ++i) {
+			if (c->conn[i].s == SYS_SOCK_BAD || !FD_ISSET(c->conn[i].s, &rd)) continue;
 
-	uint32_t bad = 0;
-	for (uint32_t i = 0; i < k; ++i) bad += bitset_get(bad_bits, i);
-	if (bad == 0) return m0;
+			int ok = net_fill(&c->conn[i]);
+			char line[NET_LINE];
+			while (ok && net_take_line(&c->conn[i], line)) ok = coord_handle(c, i, line, ck);
+			if (!ok) coord_drop(c, i);
+		}
 
-	for (uint32_t s = 1; s < start_count; ++s) {
-		bad -= bitset_get(bad_bits, s - 1);
-		bad += bitset_get(bad_bits, s + k - 1);
-		if (bad == 0) return m0 + (uint64_t)s;
+		uint64_t now = sys_now_ms();
+		for (uint32_t i = c->first_open; i < c->count; ++i) {
+			CoordRange* r = &c->r[i];
+			if (r->done || r->owner < 0 || now - r->renew_ms < c->lease_ms) continue;
+			fprintf(stderr, "; lease expired: k=%u [%llu, %llu]\n", c->k, (unsigned long long)r->a, (unsigned long long)r->b);
+			r->owner = -1;
+		}
 	}
-	return UINT64_MAX;
+
+	// nodes still scanning see the connection close at their next LIMIT
+	if (ck->path) checkpoint_save(ck);
+	int rc = (ck->bin && !plateau_bin_save(ck)) ? 1 : 0;
+	if (c->exhausted) rc = 1;
+	for (uint32_t i = 0; i < COORD_MAX_CONN; ++i)
+		if (c->conn[i].s != SYS_SOCK_BAD) sys_sock_close(c->conn[i].s);
+	sys_sock_close(ls);
+	free(c->r);
+	free(c);
+	free(ck->pts);
+	return rc;
 }
 
 // ------------------------------------------------------------
-// Worker epoch init: initialize off[] for base_test0 once per epoch
-// off[pi] = (p - (base_test0 % p)) % p, using FastDiv (no idiv), plus p==2 special.
+// Sweep orchestration: consume tiles in order, settle m(k) for k = 1..K
 // ------------------------------------------------------------
+//
+// A block m+1..m+k is valid iff it contains no value with lpf <= k. Values that are not
+// K-smooth never block any k <= K, so only the K-smooth hits are kept. last_bad is the
+// latest value known to block the current k; pending[] holds later hits (lpf > k, or
+// not yet examined) that start blocking once k grows past their lpf.
+//
 
-static void worker_init_offsets_for_epoch(WorkerCtx* w) {
-	const Epoch* e = &w->js->epoch;
-	uint32_t pc = e->primes.count;
+typedef struct SweepPending {
+	uint64_t x;
+	uint32_t q;
+} SweepPending;
 
-	ensure_worker_off(w, pc);
-	if (pc == 0) return;
+typedef struct SweepState {
+	uint32_t k;             // smallest k with m(k) not yet known
+	uint32_t K;
+	uint64_t last_bad;
 
-	uint64_t base_test0 = e->start_m + (uint64_t)w->tid * (uint64_t)e->tile_len + 1;
+	SweepPending* pend;
+	uint32_t head, scan, tail, cap;
 
-	for (uint32_t pi = 0; pi < pc; ++pi) {
-		uint32_t p = e->primes.p[pi];
-		if (p == 2) {
-			w->off[pi] = (uint32_t)(base_test0 & 1ull); // even => 0, odd => 1
+	uint64_t last_print;
+	Checkpoint* ck;         // plateau points for --bin
+} SweepState;
+
+static void sweep_emit(SweepState* s, uint32_t k, uint64_t m) {
+	if (m != s->last_print) {
+		printf("%u, %llu\n", k, (unsigned long long)m);
+		s->last_print = m;
+		checkpoint_push(s->ck, k, m);
+	}
+}
+
+static void sweep_pending_push(SweepState* s, uint64_t x, uint32_t q) {
+	if (s->tail == s->cap) {
+		if (s->head) {
+			uint32_t n = s->tail - s->head;
+			memmove(s->pend, s->pend + s->head, (size_t)n * sizeof(SweepPending));
+			s->scan -= s->head;
+			s->tail = n;
+			s->head = 0;
 		}
-		else {
-			uint32_t r = fastdiv_u32_mod(&e->fd[pi], base_test0);
-			w->off[pi] = r ? (p - r) : 0u;
+		if (s->tail == s->cap) {
+			uint32_t cap = s->cap ? s->cap * 2 : 4096;
+			SweepPending* np = (SweepPending*)realloc(s->pend, (size_t)cap * sizeof(SweepPending));
+			if (!np) {
+				fprintf(stderr, "realloc failed for sweep pending (cap=%u)\n", cap);
+				exit(2);
+			}
+			s->pend = np;
+			s->cap = cap;
 		}
 	}
+	s->pend[s->tail].x = x;
+	s->pend[s->tail].q = q;
+	++s->tail;
 }
 
-// ------------------------------------------------------------
-// Worker thread (strided tiles)
-// ------------------------------------------------------------
-
-static DWORD WINAPI worker_main(void* p) {
-	WorkerCtx* w = (WorkerCtx*)p;
-	JobSystem* js = w->js;
-	SetThreadPriority(GetCurrentThread(), THREAD_PRIORITY_BELOW_NORMAL);
+// All values <= upto have been pushed; settle every k whose block fits before the next blocker.
+static void sweep_settle(SweepState* s, uint64_t upto) {
+	while (s->k <= s->K) {
+		while (s->scan < s->tail && s->pend[s->scan].q > s->k) ++s->scan;
+
+		uint64_t bound = (s->scan < s->tail) ? s->pend[s->scan].x : upto + 1;
+		if (bound - s->last_bad - 1 >= s->k) {
+			// m(k) = last_bad; m(k+1) >= m(k), and hits before scan may now block k+1.
+			sweep_emit(s, s->k, s->last_bad);
+			++s->k;
+			s->scan = s->head;
+			continue;
+		}
+		if (s->scan == s->tail) break;
 
-	for (;;) {
-		DWORD bytes = 0;
-		ULONG_PTR key = 0;
-		LPOVERLAPPED ov = NULL;
-		GetQueuedCompletionStatus(js->iocp, &bytes, &key, &ov, INFINITE);
+		s->last_bad = bound;
+		s->head = ++s->scan;
+	}
+}
 
-		if (key == KEY_STOP) break;
+// Emit plateau points for all k <= K in one pass over m, starting at start_m.
+static void sweep_plateaus(JobSystem* js, uint32_t K, uint64_t start_m, uint32_t tile_len, uint64_t batch_tiles, Checkpoint* ck) {
+	Epoch* e = &js->epoch;
 
-		if (key == KEY_START) {
-			const Epoch* e = &js->epoch;
+	if (batch_tiles == 0) batch_tiles = 1;
+	if (batch_tiles > UINT32_MAX) batch_tiles = UINT32_MAX;
 
-			uint64_t base = e->start_m + (uint64_t)w->tid * (uint64_t)e->tile_len;
-			worker_init_offsets_for_epoch(w);
+	e->mode = EPOCH_SWEEP;
+	e->k = K;
+	e->tile_len = tile_len;
+	e->step = epoch_step(js, tile_len);
+	epoch_prepare_math(js);
 
-			for (;;) {
-				uint64_t lim = load_u64(&js->epoch.end_limit);
-				if (base > lim) {
-					worker_epoch_done(js);
-					break;
-				}
+	e->sweep_tile_count = (uint32_t)batch_tiles;
+	for (uint32_t i = 0; i < EPOCH_DEPTH; ++i) {
+		e->slot[i].sweep_tiles = (SweepTile*)calloc(e->sweep_tile_count, sizeof(SweepTile));
+		if (!e->slot[i].sweep_tiles) {
+			fprintf(stderr, "calloc failed for sweep tiles (count=%u)\n", e->sweep_tile_count);
+			exit(2);
+		}
+	}
 
-				uint64_t max_starts = (lim - base + 1);
-				uint32_t start_count = (max_starts >= e->tile_len) ? e->tile_len : (uint32_t)max_starts;
+	SweepState s;
+	memset(&s, 0, sizeof(s));
+	s.k = 1;
+	s.K = K;
+	s.last_bad = start_m;   // block must start at m >= start_m
+	s.last_print = UINT64_MAX;
+	s.ck = ck;
+
+	uint64_t cur = start_m;   // next batch to begin
+	uint64_t span = (uint64_t)tile_len * batch_tiles;
+	uint32_t begun = 0, done = 0;
+	int at_top = 0;
+
+	// workers sieve the next batch while this thread settles the previous one
+	while (s.k <= K) {
+		while (begun - done < EPOCH_DEPTH && !at_top) {
+			uint64_t end = safe_add_u64(cur, span - 1);
+			if (end == UINT64_MAX) { at_top = 1; break; }
+			epoch_begin(js, &e->slot[begun % EPOCH_DEPTH], cur, end);
+			++begun;
+			cur = end + 1;
+		}
+		if (done == begun) {
+			fprintf(stderr, "sweep reached 2^64 at k=%u\n", s.k);
+			break;
+		}
 
-				uint32_t win_len = start_count + e->k;
-				ensure_worker_buffers(w, win_len);
+		EpochSlot* es = &e->slot[done % EPOCH_DEPTH];
+		epoch_wait(js, es);
+		++done;
 
-				uint64_t found = scan_tile_find_m_carried_fastdiv(e, base, start_count, w->off, w->residual, w->bad_bits);
-				if (found != UINT64_MAX) {
-					try_set_best(js, found);
-				}
+		for (uint32_t t = 0; t < e->sweep_tile_count && s.k <= K; ++t) {
+			const SweepTile* st = &es->sweep_tiles[t];
+			uint64_t base_test = es->start_m + (uint64_t)t * tile_len + 1;
 
-				base += e->step;
-			}
+			for (uint32_t h = 0; h < st->count; ++h)
+				sweep_pending_push(&s, base_test + st->hit[h].i, st->hit[h].q);
+			sweep_settle(&s, base_test + tile_len - 1);
 		}
+		stats_tick(js, s.k, es->end_m + 1);
 	}
 
-	return 0;
+	epoch_drain(js);
+	for (uint32_t i = 0; i < EPOCH_DEPTH; ++i) {
+		EpochSlot* es = &e->slot[i];
+		for (uint32_t t = 0; t < e->sweep_tile_count; ++t) free(es->sweep_tiles[t].hit);
+		free(es->sweep_tiles);
+		es->sweep_tiles = NULL;
+	}
+	e->sweep_tile_count = 0;
+	free(s.pend);
+
+	epoch_free_math(e);
 }
 
 // ------------------------------------------------------------
-// Epoch orchestration (contiguous batch scan)
+// Batch verifier (--verify): every row of a plateau file, checked and measured
 // ------------------------------------------------------------
+//
+// A row (k, m) holds when none of m+1..m+k is k-smooth, i.e. when its true length z
+// (the largest z with every P(m+i) > z for i <= z, as verify_chain.py measures it) is
+// >= k. The rows are split over the workers in one epoch, each measured by the plateau
+// extension scan from a first window of 2 * max(k, next k) values. The primes go to twice
+// the largest first window; rows whose run reaches that bound go again with it doubled.
+// A plateau file chains when each next k is its predecessor's length + 1.
+//
+
+#ifndef VERIFY_MAX_BOUND
+#define VERIFY_MAX_BOUND (1u << 27)   // prime bound at which a still growing run is reported open
+#endif
+
+static void verify_push(VerifyRow** rows, uint32_t* count, uint32_t* cap, uint32_t k, uint64_t m) {
+	if (*count == *cap) {
+		uint32_t c = *cap ? *cap * 2 : 256;
+		VerifyRow* r = (VerifyRow*)realloc(*rows, (size_t)c * sizeof(VerifyRow));
+		if (!r) {
+			fprintf(stderr, "realloc failed for verify rows (cap=%u)\n", c);
+			exit(2);
+		}
+		*rows = r;
+		*cap = c;
+	}
+	VerifyRow* row = &(*rows)[(*count)++];
+	memset(row, 0, sizeof(*row));
+	row->k = k;
+	row->m = m;
+}
+
+// Rows are "k,m" or "k, m" lines; headers and "; ..." comments are skipped.
+static int verify_load(const char* path, VerifyRow** rows, uint32_t* count) {
+	FILE* f = fopen(path, "r");
+	if (!f) {
+		fprintf(stderr, "cannot open %s\n", path);
+		return 0;
+	}
+
+	uint32_t cap = 0;
+	char line[256];
+	while (fgets(line, sizeof(line), f)) {
+		const char* s = line;
+		while (*s == ' ' || *s == '\t') ++s;
+		if (*s < '0' || *s > '9') continue;
+
+		char* end;
+		unsigned long long k = strtoull(s, &end, 10);
+		while (*end == ' ' || *end == '\t') ++end;
+		if (*end != ',' || k == 0 || k > VERIFY_MAX_BOUND / 4) continue;
+		unsigned long long m = strtoull(end + 1, NULL, 10);
+		if (m > UINT64_MAX - VERIFY_MAX_BOUND) continue;
+		verify_push(rows, count, &cap, (uint32_t)k, (uint64_t)m);
+	}
+	fclose(f);
+	return 1;
+}
 
-static void epoch_begin(JobSystem* js, uint32_t k, uint64_t start_m, uint64_t end_m, uint32_t tile_len) {
+static int verify_run(JobSystem* js, const char* path, uint32_t tile_len) {
 	Epoch* e = &js->epoch;
+	uint64_t t0 = sys_now_ms();
 
-	e->k = k;
-	e->tile_len = tile_len;
-	e->start_m = start_m;
-	e->end_m = end_m;
-	e->step = (uint64_t)tile_len * (uint64_t)js->thread_count;
+	VerifyRow* rows = NULL;
+	uint32_t n = 0;
+	if (!verify_load(path, &rows, &n)) return 1;
 
-	InterlockedExchange64(&e->best_m, (LONG64)UINT64_MAX);
-	InterlockedExchange64(&e->end_limit, (LONG64)end_m);
+	for (uint32_t i = 0; i < n; ++i) {
+		VerifyRow* r = &rows[i];
+		r->next_k = (i + 1 < n) ? rows[i + 1].k : 0;
+		r->win = 2 * ((r->next_k > r->k) ? r->next_k : r->k);
+		r->open = 1;
+	}
 
-	ResetEvent(e->evt_done);
-	InterlockedExchange(&e->active_workers, (LONG)js->thread_count);
+	// the lpf kernel over whole windows: no buckets, no log or lean variants
+	e->mode = EPOCH_VERIFY;
+	e->kernel = KERNEL_EXACT;
+	e->bucket = 0;
+	e->tile_len = tile_len;
+	e->step = epoch_step(js, tile_len);
+
+	EpochSlot* es = &e->slot[0];
+	es->verify_rows = rows;
+	es->verify_count = n;
+
+	uint32_t bound = 0;
+	for (uint32_t i = 0; i < n; ++i)
+		if (rows[i].win > bound) bound = rows[i].win;
+	bound *= 2;
+
+	for (uint32_t pass = 0;; ++pass) {
+		uint32_t open = 0;
+		for (uint32_t i = 0; i < n; ++i) open += rows[i].open;
+		if (open == 0 || bound > VERIFY_MAX_BOUND) break;
+		fprintf(stderr, "; verify: pass %u, %u rows, primes <= %u\n", pass, open, bound);
+
+		e->k = bound;
+		epoch_prepare_math(js);
+		epoch_begin(js, es, 0, 0);
+		epoch_wait(js, es);
+		bound *= 2;
+	}
+	es->verify_rows = NULL;
+	es->verify_count = 0;
 
-	for (uint32_t i = 0; i < js->thread_count; ++i)
-		PostQueuedCompletionStatus(js->iocp, 0, KEY_START, NULL);
+	uint32_t failed = 0, gaps = 0, open = 0;
+	printf("; verify: k, m, length, chain\n");
+	for (uint32_t i = 0; i < n; ++i) {
+		const VerifyRow* r = &rows[i];
+		char st[64];
+		if (r->open) {
+			snprintf(st, sizeof(st), "OPEN (length >= %u)", r->len);
+			++open;
+		}
+		else if (r->len < r->k) {
+			snprintf(st, sizeof(st), "FAIL at %llu", (unsigned long long)(r->m + r->bad));
+			++failed;
+		}
+		else if (!r->next_k)              snprintf(st, sizeof(st), "FINAL");
+		else if (r->next_k == r->len + 1) snprintf(st, sizeof(st), "PERFECT");
+		else if (r->next_k <= r->len)     snprintf(st, sizeof(st), "OVERLAP");
+		else {
+			snprintf(st, sizeof(st), "GAP (%u)", r->next_k - r->len - 1);
+			++gaps;
+		}
+		printf("%u, %llu, %u, %s\n", r->k, (unsigned long long)r->m, r->len, st);
+	}
+
+	fprintf(stderr, "; verify: %u rows, %u failed, %u gaps, %u open, %.2f s\n",
+		n, failed, gaps, open, (double)(sys_now_ms() - t0) / 1000.0);
+	free(rows);
+	epoch_free_math(e);
+	return (failed || gaps || open) ? 1 : 0;
 }
 
-static uint64_t epoch_wait(JobSystem* js) {
-	WaitForSingleObject(js->epoch.evt_done, INFINITE);
-	return load_u64(&js->epoch.best_m);
+// ------------------------------------------------------------
+// Seed (--seed): a find run that starts from known plateau points
+// ------------------------------------------------------------
+//
+// Plateau points from k = 1 (a CSV, or a .kmp from --bin) give m(k) for every k up to the
+// last row, and m(k) >= m(k-1), so the search goes on at the last k + 1 from the last m
+// instead of replaying the table. The rows are trusted as they are; --seed-check=N first
+// searches N of them again (the last row, and others evenly spaced below it), each k from
+// the previous row's m, and refuses a file that disagrees.
+//
+
+static uint64_t kmp_get(const uint8_t* b, uint32_t bytes) {
+	uint64_t v = 0;
+	for (uint32_t i = 0; i < bytes; ++i) v |= (uint64_t)b[i] << (8 * i);
+	return v;
 }
 
-static uint64_t safe_add_u64(uint64_t a, uint64_t b) {
-	uint64_t c = a + b;
-	return (c < a) ? UINT64_MAX : c;
+// (k, m) rows of a .kmp plateau file, else of a CSV as verify_load reads it.
+static int seed_load(const char* path, VerifyRow** rows, uint32_t* count) {
+	FILE* f = fopen(path, "rb");
+	if (!f) {
+		fprintf(stderr, "cannot open %s\n", path);
+		return 0;
+	}
+	uint8_t h[KMP_HEADER];
+	if (fread(h, 1, sizeof(h), f) != sizeof(h) || kmp_get(h, 4) != KMP_MAGIC) {
+		fclose(f);
+		return verify_load(path, rows, count);
+	}
+
+	uint64_t n = kmp_get(h + 8, 8);
+	int ok = !(kmp_get(h + 4, 4) & KMP_DENSE) && n <= UINT32_MAX;
+	uint32_t cap = 0;
+	for (uint64_t i = 0; ok && i < n; ++i) {
+		uint8_t r[KMP_RECORD];
+		ok = fread(r, 1, sizeof(r), f) == sizeof(r);
+		if (ok) verify_push(rows, count, &cap, (uint32_t)kmp_get(r, 4), kmp_get(r + 4, 8));
+	}
+	fclose(f);
+	if (!ok) fprintf(stderr, "%s: not a plateau point file\n", path);
+	return ok;
 }
 
-// Find minimal m(k) by scanning contiguous batches; first batch with a solution yields global minimal.
-static uint64_t find_m_for_k(JobSystem* js, uint32_t k, uint64_t start_m, uint32_t tile_len, uint64_t batch_tiles) {
-	Epoch* e = &js->epoch;
+// Loads path, checks `check` of its rows, reprints those with k <= K (into ck as well) and
+// sets the frontier to go on from. 0 when the rows do not chain from k = 1 or a check fails.
+static int seed_run(JobSystem* js, const char* path, uint32_t K, uint32_t check, uint32_t tile_len,
+	uint64_t batch_tiles, Checkpoint* ck, uint32_t* k0, uint64_t* cur, uint64_t* last_print) {
+	VerifyRow* rows = NULL;
+	uint32_t n = 0;
+	int ok = seed_load(path, &rows, &n);
+
+	if (ok) {
+		ok = n > 0 && rows[0].k == 1;
+		for (uint32_t i = 1; ok && i < n; ++i) ok = rows[i].k > rows[i - 1].k && rows[i].m >= rows[i - 1].m;
+		if (!ok) fprintf(stderr, "%s: not plateau points from k = 1 by increasing k\n", path);
+	}
 
-	e->primes = primes_upto(k);
+	// rows past K answer every k <= K: nothing left to search
+	uint32_t keep = n;
+	while (keep && rows[keep - 1].k > K) --keep;
+
+	if (check > keep) check = keep;
+	for (uint32_t j = 0; ok && j < check; ++j) {
+		uint32_t i = keep - 1 - (uint32_t)((uint64_t)j * keep / check);
+		uint64_t lb = i ? rows[i - 1].m : 0;
+		uint64_t t0 = sys_now_ms();
+		uint64_t m = find_m_for_k(js, rows[i].k, lb, tile_len, batch_tiles, NULL);
+		ok = (m == rows[i].m);
+		fprintf(stderr, "; seed: k=%u, m=%llu %s (%.2f s)\n", rows[i].k, (unsigned long long)rows[i].m,
+			ok ? "checked" : "FAILED", (double)(sys_now_ms() - t0) / 1000.0);
+		if (!ok) fprintf(stderr, "%s: k=%u searches to m=%llu, not %llu\n", path, rows[i].k,
+			(unsigned long long)m, (unsigned long long)rows[i].m);
+	}
 
-	// Precompute math arrays for this k (step depends on tile_len and thread_count).
-	e->k = k;
-	e->tile_len = tile_len;
-	e->step = (uint64_t)tile_len * (uint64_t)js->thread_count;
-	epoch_prepare_math(js);
+	if (ok && keep) {
+		for (uint32_t i = 0; i < keep; ++i) {
+			printf("%u, %llu\n", rows[i].k, (unsigned long long)rows[i].m);
+			checkpoint_push(ck, rows[i].k, rows[i].m);
+		}
+		*k0 = (keep < n) ? K + 1 : rows[keep - 1].k + 1;
+		*cur = *last_print = rows[keep - 1].m;
+		fprintf(stderr, "; seed: %u rows, k=%u, m >= %llu\n", keep, *k0, (unsigned long long)*cur);
+	}
+	free(rows);
+	return ok;
+}
 
-	uint64_t cur = start_m;
+// ------------------------------------------------------------
+// Worker placement: physical cores first, SMT siblings and efficiency classes by policy
+// ------------------------------------------------------------
+//
+// Two workers on one core share its L1/L2, and residual[] is sized to fill them, so
+// every core gets a worker before any core gets a second one. On hybrid parts the
+// slower efficiency classes come after the fastest (or are left out, or used alone), and
+// an L2 shared by a cluster of cores is split between the workers placed on it.
+//
 
-	for (;;) {
-		uint64_t span = (uint64_t)tile_len * batch_tiles;
-		if (span == 0) span = tile_len;
+typedef struct SysCpu {
+	uint32_t group;     // Win32 processor group (0 on POSIX)
+	uint32_t number;    // CPU in the group (POSIX: the CPU id)
+	uint32_t core;      // physical core, numbered from 0
+	uint32_t sib;       // rank among the logical CPUs of its core (0: the first)
+	uint32_t perf;      // efficiency class, higher is faster (all equal on uniform parts)
+	uint32_t l2;        // bytes of the L2 this CPU uses (0: not reported)
+	uint32_t l2_id;     // which L2 that is
+	uint32_t seq;       // enumeration order
+} SysCpu;
+
+static int place_cmp(const void* a, const void* b) {
+	const SysCpu* x = (const SysCpu*)a;
+	const SysCpu* y = (const SysCpu*)b;
+	if (x->sib != y->sib)   return (x->sib > y->sib) - (x->sib < y->sib);
+	if (x->perf != y->perf) return (x->perf < y->perf) - (x->perf > y->perf);
+	return (x->seq > y->seq) - (x->seq < y->seq);
+}
 
-		uint64_t end = safe_add_u64(cur, span - 1);
-		epoch_begin(js, k, cur, end, tile_len);
+// Sorts the n CPUs into the order workers take them, after dropping what pl->ecores
+// excludes; returns how many are left and sets pl->cores.
+static uint32_t place_order(Placement* pl, SysCpu* c, uint32_t n) {
+	uint32_t hi = 0, lo = UINT32_MAX;
+	for (uint32_t i = 0; i < n; ++i) {
+		c[i].seq = i;
+		if (c[i].perf > hi) hi = c[i].perf;
+		if (c[i].perf < lo) lo = c[i].perf;
+	}
+	if (n && hi != lo && pl->ecores != ECORES_LAST) {
+		uint32_t keep = 0;
+		for (uint32_t i = 0; i < n; ++i)
+			if ((c[i].perf == hi) == (pl->ecores == ECORES_OFF)) c[keep++] = c[i];
+		n = keep;
+	}
+	qsort(c, n, sizeof(SysCpu), place_cmp);
 
-		uint64_t best = epoch_wait(js);
-		if (best != UINT64_MAX) {
-			primes_free(&e->primes);
-			epoch_free_math(e);
-			return best;
-		}
+	pl->cores = 0;
+	for (uint32_t i = 0; i < n; ++i) pl->cores += (c[i].sib == 0);
+	return n;
+}
 
-		cur = safe_add_u64(end, 1);
+// Smallest L2 share among the first count CPUs, each L2 split between the workers on it.
+static uint32_t place_l2_share(const SysCpu* c, uint32_t count) {
+	uint32_t best = 0;
+	for (uint32_t i = 0; i < count; ++i) {
+		if (!c[i].l2) continue;
+		uint32_t users = 0;
+		for (uint32_t j = 0; j < count; ++j) users += (c[j].l2 && c[j].l2_id == c[i].l2_id);
+		uint32_t share = c[i].l2 / users;
+		if (!best || share < best) best = share;
 	}
+	return best;
+}
+
+// thread_count 0: one worker per physical core (every logical CPU with --smt).
+static void place_threads(JobSystem* js, uint32_t placed, uint32_t total) {
+	if (!placed) placed = total;   // no CPU list: unpinned, as many as the system reports
+	if (js->thread_count == 0)
+		js->thread_count = (js->place.smt || !js->place.cores) ? placed : js->place.cores;
+	if (js->thread_count > placed) js->thread_count = placed;
 }
 
 // ------------------------------------------------------------
-// Thread pool start/stop + waiting (supports >64 threads)
+// Thread pool start/stop + waiting (Win32: processor groups, >64 threads)
 // ------------------------------------------------------------
 
-static void wait_all_threads(HANDLE* th, uint32_t count) {
+#ifdef _WIN32
+
+static DWORD WINAPI worker_thread(void* p) {
+	if (((WorkerCtx*)p)->js->place.priority == PRIORITY_LOW)
+		SetThreadPriority(GetCurrentThread(), THREAD_PRIORITY_BELOW_NORMAL);
+	worker_main((WorkerCtx*)p);
+	return 0;
+}
+
+static void wait_all_threads(SysThread* th, uint32_t count) {
 	// WaitForMultipleObjects max is 64; use chunking.
 	const DWORD MAXW = MAXIMUM_WAIT_OBJECTS; // 64
 	uint32_t i = 0;
@@ -549,6 +4233,7 @@ static void wait_all_threads(HANDLE* th, uint32_t count) {
 		WaitForMultipleObjects(n, th + i, TRUE, INFINITE);
 		i += n;
 	}
+	for (i = 0; i < count; ++i) CloseHandle(th[i]);
 }
 
 static uint32_t count_total_logical(void) {
@@ -561,134 +4246,718 @@ static uint32_t count_total_logical(void) {
 	return total;
 }
 
-static int start_workers(JobSystem* js, WorkerCtx* w, HANDLE* threads) {
-	// If caller passed 0, you can set it to total logical here; else cap.
+// Per-core L1 data and L2 sizes in bytes (0 where not reported), from the first of each.
+static void sys_cache_sizes(uint32_t* l1d, uint32_t* l2) {
+	*l1d = *l2 = 0;
+	DWORD len = 0;
+	GetLogicalProcessorInformationEx(RelationCache, NULL, &len);
+	uint8_t* buf = len ? (uint8_t*)malloc(len) : NULL;
+	if (!buf) return;
+
+	if (GetLogicalProcessorInformationEx(RelationCache, (PSYSTEM_LOGICAL_PROCESSOR_INFORMATION_EX)buf, &len)) {
+		for (DWORD at = 0; at < len;) {
+			const SYSTEM_LOGICAL_PROCESSOR_INFORMATION_EX* x = (const SYSTEM_LOGICAL_PROCESSOR_INFORMATION_EX*)(buf + at);
+			const CACHE_RELATIONSHIP* c = &x->Cache;
+			if (c->Level == 1 && c->Type != CacheInstruction && !*l1d) *l1d = c->CacheSize;
+			if (c->Level == 2 && !*l2) *l2 = c->CacheSize;
+			at += x->Size;
+		}
+	}
+	free(buf);
+}
+
+// Logical CPUs of the active groups with core, SMT rank, efficiency class and L2, from
+// GetLogicalProcessorInformationEx; group order, one core each, when that fails.
+static uint32_t sys_cpu_list(SysCpu** out) {
 	uint32_t total = count_total_logical();
-	if (js->thread_count == 0) js->thread_count = total;
-	if (js->thread_count > total) js->thread_count = total;
+	SysCpu* c = (SysCpu*)calloc(total ? total : 1, sizeof(SysCpu));
+	if (!c) {
+		fprintf(stderr, "calloc failed for the CPU list (count=%u)\n", total);
+		exit(2);
+	}
+	uint32_t n = 0;
+
+	DWORD len = 0;
+	GetLogicalProcessorInformationEx(RelationAll, NULL, &len);
+	uint8_t* buf = len ? (uint8_t*)malloc(len) : NULL;
+	if (buf && GetLogicalProcessorInformationEx(RelationAll, (PSYSTEM_LOGICAL_PROCESSOR_INFORMATION_EX)buf, &len)) {
+		uint32_t core = 0, l2_id = 0;
+		for (DWORD at = 0; at < len;) {
+			const SYSTEM_LOGICAL_PROCESSOR_INFORMATION_EX* x = (const SYSTEM_LOGICAL_PROCESSOR_INFORMATION_EX*)(buf + at);
+			at += x->Size;
+			if (x->Relationship != RelationProcessorCore) continue;
+			uint32_t sib = 0;
+			for (WORD g = 0; g < x->Processor.GroupCount; ++g) {
+				const GROUP_AFFINITY* ga = &x->Processor.GroupMask[g];
+				for (uint32_t b = 0; b < 64 && n < total; ++b) {
+					if (!((ga->Mask >> b) & 1)) continue;
+					c[n].group = ga->Group;
+					c[n].number = b;
+					c[n].core = core;
+					c[n].sib = sib++;
+					c[n].perf = x->Processor.EfficiencyClass;
+					++n;
+				}
+			}
+			++core;
+		}
+		for (DWORD at = 0; at < len;) {
+			const SYSTEM_LOGICAL_PROCESSOR_INFORMATION_EX* x = (const SYSTEM_LOGICAL_PROCESSOR_INFORMATION_EX*)(buf + at);
+			at += x->Size;
+			if (x->Relationship != RelationCache || x->Cache.Level != 2) continue;
+			const GROUP_AFFINITY* ga = &x->Cache.GroupMask;
+			for (uint32_t i = 0; i < n; ++i) {
+				if (c[i].group != ga->Group || !((ga->Mask >> c[i].number) & 1)) continue;
+				c[i].l2 = x->Cache.CacheSize;
+				c[i].l2_id = l2_id;
+			}
+			++l2_id;
+		}
+	}
+	free(buf);
+
+	if (n == 0) {
+		WORD groups = GetActiveProcessorGroupCount();
+		for (WORD g = 0; g < groups; ++g) {
+			DWORD cores = GetActiveProcessorCount(g);
+			if (cores > 64) cores = 64;   // defensive: groups are max 64 LPs
+			for (DWORD i = 0; i < cores && n < total; ++i, ++n) {
+				c[n].group = g;
+				c[n].number = i;
+				c[n].core = n;
+			}
+		}
+	}
+	*out = c;
+	return n;
+}
+
+static int start_workers(JobSystem* js, WorkerCtx* w, SysThread* threads) {
+	SysCpu* cpu;
+	uint32_t n = sys_cpu_list(&cpu);
+	n = place_order(&js->place, cpu, n);
+	place_threads(js, n, count_total_logical());
+	js->place.l2 = place_l2_share(cpu, js->thread_count);
 
-	WORD groups = GetActiveProcessorGroupCount();
 	uint32_t i = 0;
+	for (; i < js->thread_count; ++i) {
+		w[i].js = js;
+		w[i].tid = i;
 
-	for (WORD g = 0; g < groups && i < js->thread_count; ++g) {
-		DWORD cores = GetActiveProcessorCount(g);
+		HANDLE th = CreateThread(NULL, 0, worker_thread, &w[i], CREATE_SUSPENDED, NULL);
+		if (!th) break;
 
-		// defensive: groups are max 64 LPs
-		if (cores > 64) cores = 64;
+		GROUP_AFFINITY ga = { 0 };
+		ga.Group = (WORD)cpu[i].group;
+		ga.Mask = (KAFFINITY)(1ull << cpu[i].number);
 
-		for (DWORD c = 0; c < cores && i < js->thread_count; ++c) {
-			w[i].js = js;
-			w[i].tid = i;
+		if (!SetThreadGroupAffinity(th, &ga, NULL)) {
+			CloseHandle(th);
+			break;
+		}
 
-			HANDLE th = CreateThread(NULL, 0, worker_main, &w[i], CREATE_SUSPENDED, NULL);
-			if (!th) return 0;
+		PROCESSOR_NUMBER pn = { 0 };
+		pn.Group = (WORD)cpu[i].group;
+		pn.Number = (BYTE)cpu[i].number;
+		USHORT node = 0;
+		if (!GetNumaProcessorNodeEx(&pn, &node) || node >= SYS_MAX_NODES) node = 0;
+		w[i].node = node;
 
-			GROUP_AFFINITY ga = { 0 };
-			ga.Group = g;
-			ga.Mask = (KAFFINITY)(1ull << c);
+		ResumeThread(th);
 
-			if (!SetThreadGroupAffinity(th, &ga, NULL)) {
-				CloseHandle(th);
-				return 0;
-			}
+		threads[i] = th;
+		w[i].thread = th;
+	}
+	free(cpu);
+	return (i == js->thread_count);
+}
+
+#else
 
-			// Optional: hint the scheduler (not required when hard-affinitized)
-			// PROCESSOR_NUMBER pn = { .Group = g, .Number = (BYTE)c, .Reserved = 0 };
-			// SetThreadIdealProcessorEx(th, &pn, NULL);
+static void* worker_thread(void* p) {
+	worker_main((WorkerCtx*)p);
+	return NULL;
+}
+
+// NUMA node of a CPU from its sysfs nodeN link; 0 where there is none.
+static uint32_t sys_cpu_node(int cpu) {
+	char path[64];
+	for (uint32_t n = 0; n < SYS_MAX_NODES; ++n) {
+		snprintf(path, sizeof(path), SYS_CPU_ROOT "/cpu%d/node%u", cpu, n);
+		if (access(path, F_OK) == 0) return n;
+	}
+	return 0;
+}
+
+static void wait_all_threads(SysThread* th, uint32_t count) {
+	for (uint32_t i = 0; i < count; ++i) pthread_join(th[i], NULL);
+}
+
+static uint32_t count_total_logical(void) {
+	cpu_set_t set;
+	if (sched_getaffinity(0, sizeof(set), &set) == 0) return (uint32_t)CPU_COUNT(&set);
+	long n = sysconf(_SC_NPROCESSORS_ONLN);
+	return (n > 0) ? (uint32_t)n : 1u;
+}
+
+// Level, type ("Data", "Instruction", "Unified"; type may be NULL) and size in bytes of
+// cache index idx of a CPU; 0 past its last cache.
+static int sys_cache_index(int cpu, uint32_t idx, uint32_t* level, char type[16], uint32_t* size) {
+	char path[96];
+	unsigned lv = 0, sz = 0;
+	char unit = 0;
+
+	snprintf(path, sizeof(path), SYS_CPU_ROOT "/cpu%d/cache/index%u/level", cpu, idx);
+	FILE* f = fopen(path, "r");
+	if (!f) return 0;
+	int ok = fscanf(f, "%u", &lv) == 1;
+	fclose(f);
+
+	if (type) {
+		type[0] = 0;
+		snprintf(path, sizeof(path), SYS_CPU_ROOT "/cpu%d/cache/index%u/type", cpu, idx);
+		if (ok && (f = fopen(path, "r"))) { ok = fscanf(f, "%15s", type) == 1; fclose(f); }
+	}
+	snprintf(path, sizeof(path), SYS_CPU_ROOT "/cpu%d/cache/index%u/size", cpu, idx);
+	if (ok && (f = fopen(path, "r"))) { ok = fscanf(f, "%u%c", &sz, &unit) >= 1; fclose(f); }
+
+	if (unit == 'K') sz <<= 10;
+	else if (unit == 'M') sz <<= 20;
+	*level = ok ? lv : 0;   // unreadable: skipped, not the end
+	*size = sz;
+	return 1;
+}
+
+// Per-core L1 data and L2 sizes in bytes (0 where not reported), from cpu0's sysfs caches.
+static void sys_cache_sizes(uint32_t* l1d, uint32_t* l2) {
+	*l1d = *l2 = 0;
+	for (uint32_t i = 0; i < 8; ++i) {
+		char type[16];
+		uint32_t level, size;
+		if (!sys_cache_index(0, i, &level, type, &size)) break;
+		if (level == 1 && strcmp(type, "Instruction") != 0 && !*l1d) *l1d = size;
+		if (level == 2 && !*l2) *l2 = size;
+	}
+}
 
-			ResumeThread(th);
+// One number from a sysfs file; 0 when it is missing.
+static int sys_read_u32(const char* path, uint32_t* v) {
+	FILE* f = fopen(path, "r");
+	if (!f) return 0;
+	int ok = fscanf(f, "%u", v) == 1;
+	fclose(f);
+	return ok;
+}
 
-			threads[i] = th;
-			w[i].thread = th;
-			++i;
+// cpu in a sysfs CPU list such as "0-3,8,10-11"; -1 when the file is missing.
+static int sys_cpu_in_list(const char* path, int cpu) {
+	FILE* f = fopen(path, "r");
+	if (!f) return -1;
+	int in = 0;
+	unsigned a, b;
+	while (!in && fscanf(f, "%u", &a) == 1) {
+		b = a;
+		int ch = fgetc(f);
+		if (ch == '-') {
+			if (fscanf(f, "%u", &b) != 1) break;
+			ch = fgetc(f);
 		}
+		in = (unsigned)cpu >= a && (unsigned)cpu <= b;
+		if (ch != ',') break;
 	}
-	// If you want strict: require i == js->thread_count
-	return (i == js->thread_count);
+	fclose(f);
+	return in;
+}
+
+// The CPUs of the process mask with core (package and core_id), SMT rank, efficiency
+// class (cpu_capacity; Intel hybrid: outside cpu_atom) and L2, from sysfs.
+static uint32_t sys_cpu_list(SysCpu** out) {
+	cpu_set_t allowed;
+	if (sched_getaffinity(0, sizeof(allowed), &allowed) != 0) CPU_ZERO(&allowed);
+	uint32_t count = (uint32_t)CPU_COUNT(&allowed);
+	SysCpu* c = (SysCpu*)calloc(count ? count : 1, sizeof(SysCpu));
+	uint64_t* key = (uint64_t*)calloc(count ? count : 1, sizeof(uint64_t));
+	if (!c || !key) {
+		fprintf(stderr, "calloc failed for the CPU list (count=%u)\n", count);
+		exit(2);
+	}
+
+	uint32_t n = 0, cores = 0;
+	for (int cpu = 0; cpu < CPU_SETSIZE && n < count; ++cpu) {
+		if (!CPU_ISSET(cpu, &allowed)) continue;
+		char path[96];
+		uint32_t pkg = 0, id = (uint32_t)cpu, cap = 0;
+		snprintf(path, sizeof(path), SYS_CPU_ROOT "/cpu%d/topology/physical_package_id", cpu);
+		sys_read_u32(path, &pkg);
+		snprintf(path, sizeof(path), SYS_CPU_ROOT "/cpu%d/topology/core_id", cpu);
+		sys_read_u32(path, &id);
+		key[n] = ((uint64_t)pkg << 32) | id;
+
+		SysCpu* x = &c[n];
+		x->number = (uint32_t)cpu;
+		x->core = cores;
+		for (uint32_t j = 0; j < n; ++j) {
+			if (key[j] != key[n]) continue;
+			x->core = c[j].core;
+			++x->sib;
+		}
+		if (x->core == cores) ++cores;
+
+		snprintf(path, sizeof(path), SYS_CPU_ROOT "/cpu%d/cpu_capacity", cpu);
+		if (sys_read_u32(path, &cap)) x->perf = cap;
+		else x->perf = (sys_cpu_in_list("/sys/devices/cpu_atom/cpus", cpu) == 1) ? 0 : 1;
+
+		for (uint32_t i = 0; i < 8; ++i) {
+			uint32_t level = 0, size = 0;
+			if (!sys_cache_index(cpu, i, &level, NULL, &size)) break;
+			if (level != 2) continue;
+			x->l2 = size;
+			x->l2_id = (uint32_t)cpu;   // the lowest CPU on it
+			snprintf(path, sizeof(path), SYS_CPU_ROOT "/cpu%d/cache/index%u/shared_cpu_list", cpu, i);
+			for (int j = 0; j < cpu; ++j)
+				if (sys_cpu_in_list(path, j) == 1) { x->l2_id = (uint32_t)j; break; }
+			break;
+		}
+		++n;
+	}
+	free(key);
+	*out = c;
+	return n;
+}
+
+static int start_workers(JobSystem* js, WorkerCtx* w, SysThread* threads) {
+	SysCpu* cpu;
+	uint32_t n = sys_cpu_list(&cpu);
+	n = place_order(&js->place, cpu, n);
+	place_threads(js, n, count_total_logical());
+	js->place.l2 = place_l2_share(cpu, n ? js->thread_count : 0);
+
+	// worker i is pinned to the i-th CPU of the placement order (cpusets / taskset respected)
+	int ok = 1;
+	for (uint32_t i = 0; ok && i < js->thread_count; ++i) {
+		w[i].js = js;
+		w[i].tid = i;
+
+		pthread_attr_t attr;
+		pthread_attr_init(&attr);
+		if (i < n) {
+			cpu_set_t one;
+			CPU_ZERO(&one);
+			CPU_SET((int)cpu[i].number, &one);
+			pthread_attr_setaffinity_np(&attr, sizeof(one), &one);
+			w[i].node = sys_cpu_node((int)cpu[i].number);
+		}
+
+		ok = pthread_create(&threads[i], &attr, worker_thread, &w[i]) == 0;
+		pthread_attr_destroy(&attr);
+		if (ok) w[i].thread = threads[i];
+	}
+	free(cpu);
+	return ok;
 }
 
+#endif
+
 static void stop_workers(JobSystem* js) {
 	for (uint32_t i = 0; i < js->thread_count; ++i)
-		PostQueuedCompletionStatus(js->iocp, 0, KEY_STOP, NULL);
+		jobq_post(&js->jobs, KEY_STOP, 0);
+}
+
+// ------------------------------------------------------------
+// Auto-tune (find mode): tile_len per k range from timed calibration spans
+// ------------------------------------------------------------
+//
+// Candidates keep a kernel's per-value working set (u64 residual, u32 lean word or log
+// byte) at the L1d, L2/4, L2/2 and L2 sizes, plus the tile_len given. Calibration is real
+// search: each candidate in turn decides the next TUNE_SPAN starts per thread, so nothing
+// is scanned twice, and the fastest then serves every k up to TUNE_GROWTH times this one.
+// batch_tiles follows the tile so the batch span (tile_len * batch_tiles) stays as given.
+//
+
+#ifndef TUNE_SPAN
+#define TUNE_SPAN   (1u << 22)  // calibration starts per thread per candidate
+#endif
+#ifndef TUNE_GROWTH
+#define TUNE_GROWTH 2u          // recalibrate once k has grown by this factor
+#endif
+#define TUNE_MAX    8
+#ifndef TILE_L2_FILL
+#define TILE_L2_FILL 2u         // tile_len 0: the working set is this fraction of a worker's L2
+#endif
+
+typedef struct Tuner {
+	uint32_t tile[TUNE_MAX];    // candidates, increasing
+	uint32_t count;
+	uint64_t span;              // batch span to keep
+	uint32_t next_k;            // calibrate at the first search with k >= next_k
+	uint32_t tile_len;          // current choice
+	uint64_t batch_tiles;
+} Tuner;
+
+static uint64_t tune_batch(const JobSystem* js, const Tuner* tu, uint32_t tile_len) {
+	uint64_t b = tu->span / tile_len;
+	if (b < js->thread_count) b = js->thread_count;   // a tile per lane
+	if (js->epoch.schedule == SCHED_STEAL && b > UINT32_MAX - 1) b = UINT32_MAX - 1;
+	return b;
+}
+
+static void tune_init(Tuner* tu, const JobSystem* js, uint32_t tile_len, uint64_t batch_tiles) {
+	uint32_t l1d, l2;
+	sys_cache_sizes(&l1d, &l2);
+	if (js->place.l2) l2 = js->place.l2;   // what one worker has of its L2
+	if (!l1d) l1d = 32u << 10;
+	if (!l2)  l2 = 1u << 20;
+
+	uint32_t bytes = (js->epoch.kernel == KERNEL_LOG) ? 1u : (js->epoch.kernel == KERNEL_LEAN) ? 4u : 8u;
+	uint32_t ws[5] = { l1d, l2 / 4, l2 / 2, l2, 0 };
+
+	memset(tu, 0, sizeof(*tu));
+	for (uint32_t i = 0; i < 5; ++i) {
+		uint32_t t = tile_len;
+		if (ws[i]) {
+			t = 1u << (31 - __builtin_clz(ws[i] / bytes | 1u));   // round down to a power of two
+			if (t < 4096u) t = 4096u;
+			if (t > (1u << 22)) t = 1u << 22;
+		}
+		uint32_t j = 0;
+		while (j < tu->count && tu->tile[j] < t) ++j;
+		if (j < tu->count && tu->tile[j] == t) continue;
+		memmove(&tu->tile[j + 1], &tu->tile[j], (tu->count - j) * sizeof(uint32_t));
+		tu->tile[j] = t;
+		++tu->count;
+	}
+
+	tu->span = (uint64_t)tile_len * batch_tiles;
+	tu->next_k = 1;
+	tu->tile_len = tile_len;
+	tu->batch_tiles = batch_tiles;
+
+	fprintf(stderr, "; tune: L1d %uK, L2 %uK, tile_len", l1d >> 10, l2 >> 10);
+	for (uint32_t i = 0; i < tu->count; ++i) fprintf(stderr, " %u", tu->tile[i]);
+	fprintf(stderr, "\n");
+}
+
+// tile_len when none is given: a kernel's per-value working set (as in tune_init) at
+// 1/TILE_L2_FILL of a worker's L2 share; the exact kernel on 1 MB per worker gets 65536.
+static uint32_t tile_for_l2(uint32_t l2, uint32_t kernel) {
+	if (!l2) return 65536u;
+	uint32_t bytes = (kernel == KERNEL_LOG) ? 1u : (kernel == KERNEL_LEAN) ? 4u : 8u;
+	uint32_t t = 1u << (31 - __builtin_clz(l2 / TILE_L2_FILL / bytes | 1u));
+	if (t < 4096u) t = 4096u;
+	if (t > (1u << 22)) t = 1u << 22;
+	return t;
+}
+
+// find_m_for_k with the tuned tile_len; calibrates first when k reached tu->next_k. A
+// solution inside a calibration span ends it early, and the next search calibrates again.
+static uint64_t find_m_tuned(JobSystem* js, Tuner* tu, uint32_t k, uint64_t start_m, Checkpoint* ck) {
+	if (k >= tu->next_k && tu->count > 1) {
+		uint64_t span = (uint64_t)TUNE_SPAN * js->thread_count;
+		uint64_t a = start_m, best_us = UINT64_MAX;
+		uint32_t best = tu->tile_len;
+
+		// the current choice goes first: a search that ends inside its span ran as before
+		for (uint32_t i = 0; i <= tu->count; ++i) {
+			uint32_t t = i ? tu->tile[i - 1] : tu->tile_len;
+			if (i && t == tu->tile_len) continue;
+			uint64_t b = safe_add_u64(a, span - 1);
+			// as for node ranges: contig lanes must sieve through b + k to decide start b
+			uint64_t stop = (js->epoch.schedule == SCHED_CONTIG) ? safe_add_u64(b, k - 1) : b;
+
+			find_begin_k(js, k, t);
+			uint64_t t0 = sys_now_us();
+			uint64_t m = find_scan(js, a, stop, UINT64_MAX, tune_batch(js, tu, t), ck, NULL);
+			uint64_t us = sys_now_us() - t0;
+			find_end_k(js);
+
+			if (m != UINT64_MAX) return m;
+			if (us < best_us) { best_us = us; best = t; }
+			a = b + 1;
+		}
+
+		tu->tile_len = best;
+		tu->batch_tiles = tune_batch(js, tu, best);
+		tu->next_k = (k > UINT32_MAX / TUNE_GROWTH) ? UINT32_MAX : k * TUNE_GROWTH;
+		fprintf(stderr, "; tune k=%u: tile_len %u, batch_tiles %llu (%.1f Mstarts/s)\n", k, best,
+			(unsigned long long)tu->batch_tiles, (double)span / (double)(best_us ? best_us : 1));
+		start_m = a;
+	}
+	return find_m_for_k(js, k, start_m, tu->tile_len, tu->batch_tiles, ck);
 }
 
 // ------------------------------------------------------------
 // Main
 // ------------------------------------------------------------
 
+#ifndef MK_NO_MAIN   // mk_bench.c includes this file for the kernels
 int main(int argc, char** argv) {
 	setvbuf(stdout, NULL, _IONBF, 0);
 
 	uint32_t K = 200;
 
-	SYSTEM_INFO si;
-	GetSystemInfo(&si);
-	uint32_t threads = si.dwNumberOfProcessors ? si.dwNumberOfProcessors : 8;
+	uint32_t threads = 0;
 
-	uint32_t tile_len = 65536;
+	uint32_t tile_len = 0;   // 0: from the workers' L2 share (TILE_L2_FILL)
 	uint64_t batch_tiles = 128;
-
-	if (argc >= 2) K = (uint32_t)strtoul(argv[1], 0, 10);
-	if (argc >= 3) threads = (uint32_t)strtoul(argv[2], 0, 10);
-	if (argc >= 4) tile_len = (uint32_t)strtoul(argv[3], 0, 10);
-	if (argc >= 5) batch_tiles = (uint64_t)_strtoui64(argv[4], 0, 10);
-
-	SetPriorityClass(GetCurrentProcess(), BELOW_NORMAL_PRIORITY_CLASS);
-
+	int sweep = 0;
+	uint32_t schedule = SCHED_STRIDED;
+	uint32_t bucket = 0;
+	uint32_t kernel = KERNEL_EXACT;
+	uint32_t simd_max = SIMD_AVX512;
+	int simd_small = 0;
+	int resume = 0;
+	int skip = 0;
+	int tune = 0;
+	const char* serve_port = NULL;
+	const char* connect_addr = NULL;
+	const char* verify_path = NULL;
+	const char* seed_path = NULL;
+	uint32_t seed_check = 0;
+	uint64_t lease_s = 600;
+	Checkpoint ck;
+	memset(&ck, 0, sizeof(ck));
 	JobSystem js;
 	memset(&js, 0, sizeof(js));
-	js.thread_count = threads;
 
-	js.iocp = CreateIoCompletionPort(INVALID_HANDLE_VALUE, NULL, 0, threads);
-	if (!js.iocp) {
-		fprintf(stderr, "CreateIoCompletionPort failed: %lu\n", GetLastError());
+	for (int a = 1, pos = 0; a < argc; ++a) {
+		const char* arg = argv[a];
+		if (strcmp(arg, "--sweep") == 0) { sweep = 1; continue; }
+		if (strcmp(arg, "--contig") == 0) { schedule = SCHED_CONTIG; continue; }
+		if (strcmp(arg, "--bucket") == 0) { bucket = 1; schedule = SCHED_CONTIG; continue; }
+		if (strcmp(arg, "--log") == 0) { kernel = KERNEL_LOG; continue; }
+		if (strcmp(arg, "--lean") == 0) { kernel = KERNEL_LEAN; continue; }
+		if (strcmp(arg, "--steal") == 0) { schedule = SCHED_STEAL; continue; }
+		if (strcmp(arg, "--simd-small") == 0) { simd_small = 1; continue; }
+		if (strcmp(arg, "--resume") == 0) { resume = 1; continue; }
+		if (strcmp(arg, "--skip") == 0) { skip = 1; continue; }
+		if (strcmp(arg, "--tune") == 0) { tune = 1; continue; }
+		if (strcmp(arg, "--smt") == 0) { js.place.smt = 1; continue; }
+		if (strncmp(arg, "--ecores=", 9) == 0) {
+			const char* v = arg + 9;
+			if      (strcmp(v, "last") == 0) js.place.ecores = ECORES_LAST;
+			else if (strcmp(v, "off") == 0)  js.place.ecores = ECORES_OFF;
+			else if (strcmp(v, "only") == 0) js.place.ecores = ECORES_ONLY;
+			else { fprintf(stderr, "unknown --ecores policy: %s\n", v); return 1; }
+			continue;
+		}
+		if (strncmp(arg, "--priority=", 11) == 0) {
+			const char* v = arg + 11;
+			if      (strcmp(v, "low") == 0)    js.place.priority = PRIORITY_LOW;
+			else if (strcmp(v, "idle") == 0)   js.place.priority = PRIORITY_IDLE;
+			else if (strcmp(v, "normal") == 0) js.place.priority = PRIORITY_NORMAL;
+			else { fprintf(stderr, "unknown --priority: %s\n", v); return 1; }
+			continue;
+		}
+		if (strcmp(arg, "--stats") == 0) { js.stats.on = 1; js.stats.every_ms = 10000; continue; }
+		if (strncmp(arg, "--stats=", 8) == 0) { js.stats.on = 1; js.stats.every_ms = (uint32_t)strtoul(arg + 8, 0, 10) * 1000u; continue; }
+		if (strcmp(arg, "--json") == 0) { js.stats.on = js.stats.json = 1; continue; }
+		if (strncmp(arg, "--checkpoint=", 13) == 0) { ck.path = arg + 13; continue; }
+		if (strncmp(arg, "--bin=", 6) == 0) { ck.bin = arg + 6; continue; }
+		if (strncmp(arg, "--serve=", 8) == 0) { serve_port = arg + 8; continue; }
+		if (strncmp(arg, "--connect=", 10) == 0) { connect_addr = arg + 10; continue; }
+		if (strncmp(arg, "--verify=", 9) == 0) { verify_path = arg + 9; continue; }
+		if (strncmp(arg, "--seed=", 7) == 0) { seed_path = arg + 7; continue; }
+		if (strncmp(arg, "--seed-check=", 13) == 0) { seed_check = (uint32_t)strtoul(arg + 13, 0, 10); continue; }
+		if (strncmp(arg, "--lease=", 8) == 0) { lease_s = strtoull(arg + 8, 0, 10); continue; }
+		if (strncmp(arg, "--simd=", 7) == 0) {
+			const char* v = arg + 7;
+			if      (strcmp(v, "scalar") == 0) simd_max = SIMD_SCALAR;
+			else if (strcmp(v, "avx2") == 0)   simd_max = SIMD_AVX2;
+			else if (strcmp(v, "avx512") == 0 || strcmp(v, "auto") == 0) simd_max = SIMD_AVX512;
+			else { fprintf(stderr, "unknown --simd level: %s\n", v); return 1; }
+			continue;
+		}
+
+		switch (pos++) {
+		case 0: K = (uint32_t)strtoul(arg, 0, 10); break;
+		case 1: threads = (uint32_t)strtoul(arg, 0, 10); break;
+		case 2: tile_len = (uint32_t)strtoul(arg, 0, 10); break;
+		case 3: batch_tiles = (uint64_t)strtoull(arg, 0, 10); break;
+		default:
+			fprintf(stderr, "unexpected argument: %s\n", arg);
+			return 1;
+		}
+	}
+
+	if (resume && !ck.path) { fprintf(stderr, "--resume needs --checkpoint=FILE\n"); return 1; }
+	if (sweep && kernel == KERNEL_LEAN) { fprintf(stderr, "--lean covers find mode only\n"); return 1; }
+	if (sweep && ck.path)   { fprintf(stderr, "--checkpoint covers find mode only\n"); return 1; }
+	if (sweep && (serve_port || connect_addr)) { fprintf(stderr, "distributed search covers find mode only\n"); return 1; }
+	if (connect_addr && (serve_port || ck.path || ck.bin)) { fprintf(stderr, "--connect takes no --serve/--checkpoint/--bin\n"); return 1; }
+	if (tune && (sweep || serve_port || connect_addr)) { fprintf(stderr, "--tune covers local find mode only\n"); return 1; }
+	if (verify_path && (sweep || serve_port || connect_addr || ck.path || ck.bin || tune || skip)) {
+		fprintf(stderr, "--verify takes no search flags\n");
 		return 1;
 	}
 
-	js.epoch.evt_done = CreateEventW(NULL, TRUE, FALSE, NULL);
-	if (!js.epoch.evt_done) {
-		fprintf(stderr, "CreateEvent failed: %lu\n", GetLastError());
+	if (seed_check && !seed_path) { fprintf(stderr, "--seed-check needs --seed=FILE\n"); return 1; }
+	if (seed_path && (resume || sweep || serve_port || connect_addr || verify_path)) {
+		fprintf(stderr, "--seed covers local find mode only, without --resume\n");
 		return 1;
 	}
 
+	if ((serve_port || connect_addr) && !sys_net_init()) { fprintf(stderr, "network init failed\n"); return 1; }
+	if (serve_port) return coord_run(serve_port, K, (uint64_t)(tile_len ? tile_len : 65536u) * batch_tiles, lease_s * 1000u, &ck, resume);
+
+	sys_set_priority(js.place.priority);
+	sys_memory_init();
+
+	simd_init(simd_max, simd_small);
+	wheel_init();
+	lean_init();
+	fprintf(stderr, "; simd: %s%s\n", g_simd.name, g_simd.strip_small ? " +small" : "");
+
+	js.thread_count = threads;
+	js.epoch.schedule = schedule;
+	js.epoch.bucket = bucket;
+	js.epoch.kernel = kernel;
+	js.epoch.cap_k = (connect_addr || verify_path) ? 0 : K;   // a node's k comes from the coordinator
+
+	// 0 or more than available: start_workers settles on this count
+	uint32_t total = count_total_logical();
+	if (threads == 0 || threads > total) threads = total;
+
+	if (!jobq_init(&js.jobs, threads)) return 1;
+	for (uint32_t i = 0; i < EPOCH_DEPTH; ++i)
+		if (!event_init(&js.epoch.slot[i].evt_done)) return 1;
+
 	WorkerCtx* w = (WorkerCtx*)calloc(threads, sizeof(WorkerCtx));
-	HANDLE* th = (HANDLE*)calloc(threads, sizeof(HANDLE));
+	SysThread* th = (SysThread*)calloc(threads, sizeof(SysThread));
 	if (!w || !th) return 1;
+	stats_init(&js.stats, threads);
 
 	if (!start_workers(&js, w, th)) {
 		fprintf(stderr, "Failed to start workers\n");
 		return 1;
 	}
+	threads = js.thread_count;
+	if (!tile_len) tile_len = tile_for_l2(js.place.l2, kernel);
+	fprintf(stderr, "; workers: %u on %u cores, L2 %uK per worker, tile_len %u\n",
+		threads, js.place.cores, js.place.l2 >> 10, tile_len);
+
+	js.epoch.node_count = 1;
+	for (uint32_t i = 0; i < threads; ++i)
+		if (w[i].node >= js.epoch.node_count) js.epoch.node_count = w[i].node + 1;
+	if (js.epoch.node_count > 1) fprintf(stderr, "; numa: %u nodes\n", js.epoch.node_count);
+
+	stats_mark(&js, &js.stats.run);
+	stats_mark(&js, &js.stats.beat);
+	stats_mark(&js, &js.stats.k);
+
+	if (schedule == SCHED_STEAL) {
+		// tile indices are packed 32:32, and STEAL_NONE must stay out of range
+		if (batch_tiles > UINT32_MAX - 1) batch_tiles = UINT32_MAX - 1;
+		for (uint32_t i = 0; i < EPOCH_DEPTH; ++i) {
+			js.epoch.slot[i].steal = (shared_u64*)calloc(threads, sizeof(shared_u64));
+			if (!js.epoch.slot[i].steal) {
+				fprintf(stderr, "calloc failed for steal ranges (count=%u)\n", threads);
+				return 1;
+			}
+		}
+	}
 
-	printf("; plateau points: k, m\n");
-
-	uint64_t last_m = 0;
-	uint64_t last_print = UINT64_MAX;
+	int rc = 0;
+	if (connect_addr) {
+		rc = node_run(&js, connect_addr, tile_len, batch_tiles);
+	}
+	else if (verify_path) {
+		rc = verify_run(&js, verify_path, tile_len);
+	}
+	else if (sweep) {
+		printf("; plateau points: k, m\n");
+		sweep_plateaus(&js, K, 0, tile_len, batch_tiles, &ck);
+	}
+	else {
+		uint64_t last_m = 0;
+		uint64_t last_print = UINT64_MAX;
+		uint32_t k0 = 1;
+
+		printf("; plateau points: k, m\n");
+		if (resume && !checkpoint_resume(&ck, K, &k0, &last_m, &last_print)) return 1;
+		if (seed_path && !seed_run(&js, seed_path, K, seed_check, tile_len, batch_tiles, &ck, &k0, &last_m, &last_print)) return 1;
+		ck.last_ms = sys_now_ms();
+
+		Tuner tu;
+		if (tune) tune_init(&tu, &js, tile_len, batch_tiles);
+
+		SkipIndex sk;
+		if (skip) skip_init(&sk, K);
+		int have_run = 0;   // sk describes last_m
+
+		for (uint32_t k = k0; k <= K; ++k) {
+			// positions are u64 past the origin: move it to the frontier long before they
+			// run out (the checkpoint and --bin formats hold u64 m, so not with those)
+			if (last_m >= WIDE_REBASE_AT && !ck.path && !ck.bin) {
+				find_rebase(&js, last_m);
+				last_print = (last_print == last_m) ? 0 : UINT64_MAX;
+				last_m = 0;
+				if (skip) {
+					fprintf(stderr, "; wide: --skip stops here\n");
+					skip_free(&sk);
+					skip = have_run = 0;
+				}
+			}
 
-	for (uint32_t k = 1; k <= K; ++k) {
-		uint64_t m = find_m_for_k(&js, k, last_m, tile_len, batch_tiles);
-		last_m = m;
+			uint64_t m = last_m;
+			uint32_t c = have_run ? skip_clear(&sk, k) : 0;
 
-		if (m != last_print) {
-			printf("%u, %llu\n", k, (unsigned long long)m);
-			last_print = m;
+			if (!have_run || c < k) {
+				uint64_t lb = have_run ? safe_add_u64(last_m, (uint64_t)c + 1) : last_m;
+				m = tune ? find_m_tuned(&js, &tu, k, lb, &ck) : find_m_for_k(&js, k, lb, tile_len, batch_tiles, &ck);
+				if (m == UINT64_MAX) {
+					fprintf(stderr, "; k=%u: no m below position 2^64%s; stopping\n", k,
+						js.epoch.origin ? " past the origin" : " (--checkpoint/--bin keep m in u64)");
+					rc = 1;
+					break;
+				}
+				if (skip) {
+					skip_build(&sk, m, k);
+					have_run = 1;
+				}
+			}
+			last_m = m;
+			if (js.stats.on) stats_report(&js, "k", k, m, &js.stats.k);
+
+			if (m != last_print) {
+				char mb[40];
+				printf("%u, %s\n", k, u128_str(mb, js.epoch.origin + m));
+				last_print = m;
+				checkpoint_push(&ck, k, m);
+			}
+			checkpoint_progress(&ck, k + 1, m);
 		}
+		// finished: resuming this file (with the same K) only reprints the points
+		if (ck.path && k0 <= K) checkpoint_save(&ck);
+		if (skip) skip_free(&sk);
 	}
+	if (ck.bin && !plateau_bin_save(&ck)) rc = 1;
+	free(ck.pts);
 
+	if (js.stats.on) stats_report(&js, "total", 0, 0, &js.stats.run);
 	stop_workers(&js);
 	wait_all_threads(th, threads);
 
 	for (uint32_t i = 0; i < threads; ++i) {
-		if (w[i].residual) VirtualFree(w[i].residual, 0, MEM_RELEASE);
-		if (w[i].bad_bits) VirtualFree(w[i].bad_bits, 0, MEM_RELEASE);
-		if (w[i].off)      VirtualFree(w[i].off, 0, MEM_RELEASE);
-		CloseHandle(th[i]);
+		if (w[i].residual) sys_free(w[i].residual);
+		if (w[i].bad_bits) sys_free(w[i].bad_bits);
+		if (w[i].off)      sys_free(w[i].off);
+		if (w[i].lpf)      sys_free(w[i].lpf);
+		if (w[i].logs)     sys_free(w[i].logs);
+		if (w[i].lean)     sys_free(w[i].lean);
+		if (w[i].wide)     sys_free(w[i].wide);
+		if (w[i].br.hit)   sys_free(w[i].br.hit);
+		free(w[i].br.count);
 	}
 
 	free(th);
 	free(w);
-
-	CloseHandle(js.epoch.evt_done);
-	CloseHandle(js.iocp);
-	return 0;
+	for (uint32_t i = 0; i < EPOCH_DEPTH; ++i) {
+		free((void*)js.epoch.slot[i].steal);
+		event_free(&js.epoch.slot[i].evt_done);
+	}
+	jobq_free(&js.jobs);
+	stats_free(&js.stats);
+	epoch_free_tables(&js.epoch);
+	return rc;
 }
+#endif
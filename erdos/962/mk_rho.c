@@ -0,0 +1,554 @@
+// mk_rho.c
+//
+// Prime factorization by Brent's variant of Pollard rho (../../Brent-Pollard-Rho.g) in native
+// multi-precision, on the thread pool of mk_iocp_tiled_sieve_strided_fastdiv.c (included
+// whole, without its main): an n of more than one limb runs a different polynomial x^2 + c
+// on every worker as EPOCH_TASK lanes, and the first lane to split n stops the others.
+// - n in up to RHO_MAX_LIMBS 64-bit limbs, arithmetic mod n in Montgomery form (CIOS), so a
+//   rho step is one squaring and one add. x^2 + c is iterated on the Montgomery residues as
+//   they are, which is just another polynomial of the same family
+// - Brent: the range r doubles, |x - y| goes into one running product and the GCD is taken
+//   every RHO_CHECK terms (check = 17 in the .g). A product that reaches 0 mod n is redone
+//   one term at a time from the saved y; a GCD of n itself moves the lane to its next c
+// - GCD is gcd.g's binary GCD; n is odd, so only the product's twos need stripping
+// - Before rho: twos and odd d < RHO_TRIAL by division, then Miller-Rabin to the 13 prime
+//   bases 2..41 (deterministic below 3.3e24, a probable prime above)
+// - A one-limb n splits inline on the calling thread: below 2^64 the pool costs more than
+//   it saves
+//
+// Output, one line per n (the arguments, else one n per stdin line, flushed per line so a
+// script can drive it over a pipe, as verify_chain.py does):
+//   n: p1 p2 ...       prime factors in increasing order, with multiplicity
+//   n: error           0, not a decimal number, or over RHO_MAX_LIMBS limbs
+//
+// Build (Linux / POSIX):
+//   cc -O3 -std=c11 -march=native mk_rho.c -o mk_rho -lpthread -lm
+//
+// Build (clang, in VS dev prompt):
+//   clang -O3 -std=c11 -march=native mk_rho.c -o mk_rho.exe -lkernel32 -ladvapi32 -lws2_32 -fuse-ld=lld
+//
+// Usage:
+//   mk_rho [--threads=0=HW] [N ...]
+//
+//   e.g. mk_rho 115792089237316195423570985008687907853269984665640564039457584007913129639937
+//   (F8: 1238926361552897 times a 62-digit prime)
+
+#define MK_NO_MAIN
+#if defined(__clang__) || defined(__GNUC__)
+#pragma GCC diagnostic ignored "-Wunused-function"   // the search driver is not called here
+#endif
+#include "mk_iocp_tiled_sieve_strided_fastdiv.c"
+
+#ifndef RHO_MAX_LIMBS
+#define RHO_MAX_LIMBS 40   // 2560 bits; F11 = 2^2048 + 1 needs 33
+#endif
+#ifndef RHO_CHECK
+#define RHO_CHECK 128      // terms per GCD
+#endif
+#ifndef RHO_TRIAL
+#define RHO_TRIAL 1024u    // trial division below this
+#endif
+#ifndef RHO_POOL_LIMBS
+#define RHO_POOL_LIMBS 2   // split n of at least this many limbs on the pool
+#endif
+
+#define RHO_DEC_MAX (RHO_MAX_LIMBS * 20 + 2)   // > 64 * log10(2) digits per limb
+
+// Little-endian limbs, len without leading zeros (0 has len 0).
+typedef struct Mp {
+	uint32_t len;
+	uint64_t w[RHO_MAX_LIMBS];
+} Mp;
+
+typedef struct Mont {
+	uint32_t L;                     // limbs of n; every residue below has L limbs
+	uint64_t ninv;                  // -n^-1 mod 2^64
+	uint64_t n[RHO_MAX_LIMBS];
+	uint64_t one[RHO_MAX_LIMBS];    // R mod n, R = 2^(64 L)
+	uint64_t r2[RHO_MAX_LIMBS];     // R^2 mod n
+} Mont;
+
+typedef struct RhoSplit {
+	const Mont* M;
+	uint32_t    lanes;
+	shared_u64  stop;               // c of the lane that split n, 0 while none has
+	uint64_t    f[RHO_MAX_LIMBS];   // its factor
+} RhoSplit;
+
+typedef struct RhoCtx {
+	JobSystem* js;                  // NULL: split everything inline
+	Mp*        f;                   // prime factors of the current n
+	uint32_t   count, cap;
+} RhoCtx;
+
+// ------------------------------------------------------------
+// Fixed-length limb arithmetic
+// ------------------------------------------------------------
+
+static uint64_t mpn_add(uint64_t* r, const uint64_t* a, const uint64_t* b, uint32_t L) {
+	uint64_t c = 0;
+	for (uint32_t i = 0; i < L; ++i) {
+		u128 s = (u128)a[i] + b[i] + c;
+		r[i] = (uint64_t)s;
+		c = (uint64_t)(s >> 64);
+	}
+	return c;
+}
+
+static uint64_t mpn_sub(uint64_t* r, const uint64_t* a, const uint64_t* b, uint32_t L) {
+	uint64_t br = 0;
+	for (uint32_t i = 0; i < L; ++i) {
+		uint64_t x = a[i], y = b[i];
+		uint64_t d = x - y - br;
+		br = (x < y) | ((x == y) & br);
+		r[i] = d;
+	}
+	return br;
+}
+
+static int mpn_cmp(const uint64_t* a, const uint64_t* b, uint32_t L) {
+	for (uint32_t i = L; i-- > 0;)
+		if (a[i] != b[i]) return (a[i] > b[i]) ? 1 : -1;
+	return 0;
+}
+
+static int mpn_is_zero(const uint64_t* a, uint32_t L) {
+	for (uint32_t i = 0; i < L; ++i)
+		if (a[i]) return 0;
+	return 1;
+}
+
+static void mpn_set_u64(uint64_t* r, uint64_t v, uint32_t L) {
+	memset(r, 0, (size_t)L * sizeof(uint64_t));
+	r[0] = v;
+}
+
+// a >>= ctz(a), a != 0.
+static void mpn_strip_twos(uint64_t* a, uint32_t L) {
+	uint32_t q = 0;
+	while (!a[q]) ++q;
+	uint32_t s = (uint32_t)__builtin_ctzll(a[q]);
+	if (q) {
+		memmove(a, a + q, (size_t)(L - q) * sizeof(uint64_t));
+		memset(a + L - q, 0, (size_t)q * sizeof(uint64_t));
+	}
+	if (s) {
+		for (uint32_t i = 0; i + 1 < L; ++i) a[i] = (a[i] >> s) | (a[i + 1] << (64 - s));
+		a[L - 1] >>= s;
+	}
+}
+
+// gcd.g's binary GCD of a and an odd n, into g; gcd(0, n) = n.
+static void mpn_gcd_odd(uint64_t* g, const uint64_t* a, const uint64_t* n, uint32_t L) {
+	uint64_t u[RHO_MAX_LIMBS], v[RHO_MAX_LIMBS];
+	memcpy(v, n, (size_t)L * sizeof(uint64_t));
+	if (mpn_is_zero(a, L)) { memcpy(g, v, (size_t)L * sizeof(uint64_t)); return; }
+	memcpy(u, a, (size_t)L * sizeof(uint64_t));
+	mpn_strip_twos(u, L);
+	for (;;) {
+		int c = mpn_cmp(u, v, L);
+		if (c == 0) break;
+		if (c > 0) { mpn_sub(u, u, v, L); mpn_strip_twos(u, L); }
+		else       { mpn_sub(v, v, u, L); mpn_strip_twos(v, L); }
+	}
+	memcpy(g, u, (size_t)L * sizeof(uint64_t));
+}
+
+// ------------------------------------------------------------
+// Montgomery arithmetic mod n
+// ------------------------------------------------------------
+
+// r = a b R^-1 mod n for a, b < n; r may alias either.
+static void mont_mul(const Mont* M, uint64_t* r, const uint64_t* a, const uint64_t* b) {
+	uint32_t L = M->L;
+	uint64_t t[RHO_MAX_LIMBS + 2];
+	memset(t, 0, (size_t)(L + 2) * sizeof(uint64_t));
+	for (uint32_t i = 0; i < L; ++i) {
+		uint64_t bi = b[i], c = 0;
+		for (uint32_t j = 0; j < L; ++j) {
+			u128 s = (u128)a[j] * bi + t[j] + c;
+			t[j] = (uint64_t)s;
+			c = (uint64_t)(s >> 64);
+		}
+		u128 s = (u128)t[L] + c;
+		t[L] = (uint64_t)s;
+		t[L + 1] = (uint64_t)(s >> 64);
+
+		uint64_t m = t[0] * M->ninv;   // t + m n = 0 mod 2^64: shift one limb out
+		s = (u128)m * M->n[0] + t[0];
+		c = (uint64_t)(s >> 64);
+		for (uint32_t j = 1; j < L; ++j) {
+			s = (u128)m * M->n[j] + t[j] + c;
+			t[j - 1] = (uint64_t)s;
+			c = (uint64_t)(s >> 64);
+		}
+		s = (u128)t[L] + c;
+		t[L - 1] = (uint64_t)s;
+		t[L] = t[L + 1] + (uint64_t)(s >> 64);
+	}
+	if (t[L] || mpn_cmp(t, M->n, L) >= 0) mpn_sub(r, t, M->n, L);
+	else memcpy(r, t, (size_t)L * sizeof(uint64_t));
+}
+
+// r = a + b mod n for a, b < n.
+static void mont_add(const Mont* M, uint64_t* r, const uint64_t* a, const uint64_t* b) {
+	uint64_t c = mpn_add(r, a, b, M->L);
+	if (c || mpn_cmp(r, M->n, M->L) >= 0) mpn_sub(r, r, M->n, M->L);
+}
+
+// n odd, n > 1.
+static void mont_init(Mont* M, const Mp* n) {
+	uint32_t L = n->len;
+	M->L = L;
+	memcpy(M->n, n->w, (size_t)L * sizeof(uint64_t));
+	M->ninv = 0 - inverse_u64(n->w[0]);
+
+	// 1 doubled 64 L times is R mod n, 64 L more is R^2 mod n.
+	uint64_t x[RHO_MAX_LIMBS];
+	mpn_set_u64(x, 1, L);
+	for (uint32_t i = 0; i < 128 * L; ++i) {
+		mont_add(M, x, x, x);
+		if (i + 1 == 64 * L) memcpy(M->one, x, (size_t)L * sizeof(uint64_t));
+	}
+	memcpy(M->r2, x, (size_t)L * sizeof(uint64_t));
+}
+
+// Miller-Rabin of M->n to the bases 2..41.
+static int mont_probable_prime(const Mont* M) {
+	static const uint32_t base[] = { 2, 3, 5, 7, 11, 13, 17, 19, 23, 29, 31, 37, 41 };
+	uint32_t L = M->L;
+	uint64_t d[RHO_MAX_LIMBS], nm1[RHO_MAX_LIMBS], x[RHO_MAX_LIMBS], a[RHO_MAX_LIMBS];
+
+	mpn_sub(nm1, M->n, M->one, L);   // n - 1 in Montgomery form
+	memcpy(d, M->n, (size_t)L * sizeof(uint64_t));
+	d[0] ^= 1;                          // n - 1 (n odd)
+	uint32_t s = 0;
+	while (!((d[s >> 6] >> (s & 63)) & 1)) ++s;
+	uint32_t top = 64 * L;
+	while (!((d[(top - 1) >> 6] >> ((top - 1) & 63)) & 1)) --top;
+
+	for (uint32_t b = 0; b < sizeof(base) / sizeof(base[0]); ++b) {
+		if (L == 1 && M->n[0] <= base[b]) return 1;   // only for n <= 41, which trial division has taken
+		mpn_set_u64(a, base[b], L);
+		mont_mul(M, a, a, M->r2);
+
+		memcpy(x, M->one, (size_t)L * sizeof(uint64_t));   // x = a^(d >> s), high bits first
+		for (uint32_t i = top; i-- > s;) {
+			mont_mul(M, x, x, x);
+			if ((d[i >> 6] >> (i & 63)) & 1) mont_mul(M, x, x, a);
+		}
+		if (mpn_cmp(x, M->one, L) == 0 || mpn_cmp(x, nm1, L) == 0) continue;
+		uint32_t r = 1;
+		for (; r < s; ++r) {
+			mont_mul(M, x, x, x);
+			if (mpn_cmp(x, nm1, L) == 0) break;
+			if (mpn_cmp(x, M->one, L) == 0) return 0;
+		}
+		if (r == s) return 0;
+	}
+	return 1;
+}
+
+// ------------------------------------------------------------
+// Brent-Pollard rho
+// ------------------------------------------------------------
+
+static FORCEINLINE void rho_step(const Mont* M, uint64_t* y, const uint64_t* c) {
+	mont_mul(M, y, y, y);
+	mont_add(M, y, y, c);
+}
+
+static FORCEINLINE void rho_absdiff(uint64_t* d, const uint64_t* x, const uint64_t* y, uint32_t L) {
+	if (mpn_cmp(x, y, L) >= 0) mpn_sub(d, x, y, L);
+	else mpn_sub(d, y, x, L);
+}
+
+static FORCEINLINE int rho_is_one(const uint64_t* g, uint32_t L) {
+	return g[0] == 1 && (L == 1 || mpn_is_zero(g + 1, L - 1));
+}
+
+// Brent's cycle of x^2 + c from x = 2. 1 with a proper factor in f; 0 when the cycle closed
+// on n itself, or once *stop is set.
+static int rho_brent(const Mont* M, uint64_t c, shared_u64* stop, uint64_t* f) {
+	uint32_t L = M->L;
+	uint64_t x[RHO_MAX_LIMBS], y[RHO_MAX_LIMBS], ys[RHO_MAX_LIMBS];
+	uint64_t q[RHO_MAX_LIMBS], d[RHO_MAX_LIMBS], cm[RHO_MAX_LIMBS];
+	mpn_set_u64(cm, c, L);
+	mpn_set_u64(y, 2, L);
+	memcpy(q, M->one, (size_t)L * sizeof(uint64_t));
+
+	for (uint64_t r = 1;; r <<= 1) {
+		memcpy(x, y, (size_t)L * sizeof(uint64_t));
+		for (uint64_t i = 0; i < r; ++i) {
+			if (!(i & 1023) && load_u64(stop)) return 0;
+			rho_step(M, y, cm);
+		}
+		for (uint64_t k = 0; k < r; k += RHO_CHECK) {
+			if (load_u64(stop)) return 0;
+			memcpy(ys, y, (size_t)L * sizeof(uint64_t));
+			uint64_t run = (r - k < RHO_CHECK) ? r - k : RHO_CHECK;
+			for (uint64_t i = 0; i < run; ++i) {
+				rho_step(M, y, cm);
+				rho_absdiff(d, x, y, L);
+				mont_mul(M, q, q, d);
+			}
+			mpn_gcd_odd(f, q, M->n, L);
+			if (rho_is_one(f, L)) continue;
+
+			if (mpn_cmp(f, M->n, L) == 0) {   // overshot: one term at a time from ys
+				do {
+					rho_step(M, ys, cm);
+					rho_absdiff(d, x, ys, L);
+					mpn_gcd_odd(f, d, M->n, L);
+				} while (rho_is_one(f, L));
+			}
+			return mpn_cmp(f, M->n, L) != 0;
+		}
+	}
+}
+
+static void rho_lane(WorkerCtx* w, void* arg, uint32_t lane) {
+	RhoSplit* s = (RhoSplit*)arg;
+	uint64_t f[RHO_MAX_LIMBS];
+	(void)w;
+	for (uint64_t c = 1 + lane; !load_u64(&s->stop); c += s->lanes) {
+		if (rho_brent(s->M, c, &s->stop, f) && cas_u64(&s->stop, 0, c)) {
+			memcpy(s->f, f, (size_t)s->M->L * sizeof(uint64_t));
+			break;
+		}
+	}
+}
+
+// A proper factor of the composite M->n, into d.
+static void rho_split(RhoCtx* cx, const Mont* M, Mp* d) {
+	uint32_t L = M->L;
+	memset(d, 0, sizeof(*d));
+	if (cx->js && L >= RHO_POOL_LIMBS && cx->js->thread_count > 1) {
+		RhoSplit s;
+		s.M = M;
+		s.lanes = cx->js->thread_count;
+		store_u64(&s.stop, 0);
+		epoch_run_task(cx->js, rho_lane, &s);
+		memcpy(d->w, s.f, (size_t)L * sizeof(uint64_t));
+	}
+	else {
+		shared_u64 never;
+		store_u64(&never, 0);
+		for (uint64_t c = 1; !rho_brent(M, c, &never, d->w); ++c) {}
+	}
+	d->len = L;
+	while (d->len && !d->w[d->len - 1]) --d->len;
+}
+
+// ------------------------------------------------------------
+// Numbers
+// ------------------------------------------------------------
+
+static int mp_cmp(const Mp* a, const Mp* b) {
+	if (a->len != b->len) return (a->len > b->len) ? 1 : -1;
+	return mpn_cmp(a->w, b->w, a->len);
+}
+
+// a mod d in 32-bit halves (no u128 division).
+static uint32_t mp_mod_u32(const Mp* a, uint32_t d) {
+	uint64_t r = 0;
+	for (uint32_t i = a->len; i-- > 0;) {
+		r = ((r << 32) | (a->w[i] >> 32)) % d;
+		r = ((r << 32) | (a->w[i] & 0xFFFFFFFFu)) % d;
+	}
+	return (uint32_t)r;
+}
+
+// a = a / d, returning a mod d.
+static uint32_t mp_divmod_u32(Mp* a, uint32_t d) {
+	uint64_t r = 0;
+	for (uint32_t i = a->len; i-- > 0;) {
+		uint64_t hi = (r << 32) | (a->w[i] >> 32);
+		r = hi % d;
+		uint64_t lo = (r << 32) | (a->w[i] & 0xFFFFFFFFu);
+		r = lo % d;
+		a->w[i] = ((hi / d) << 32) | (lo / d);
+	}
+	while (a->len && !a->w[a->len - 1]) --a->len;
+	return (uint32_t)r;
+}
+
+// q = a / d for an odd d that divides a: one limb of q per d^-1 mod 2^64, low first.
+static void mp_divexact(Mp* q, const Mp* a, const Mp* d) {
+	uint64_t r[RHO_MAX_LIMBS];
+	uint64_t inv = inverse_u64(d->w[0]);
+	memcpy(r, a->w, (size_t)a->len * sizeof(uint64_t));
+	memset(q, 0, sizeof(*q));
+	q->len = a->len - d->len + 1;
+	for (uint32_t i = 0; i < q->len; ++i) {
+		uint64_t qi = r[i] * inv;
+		q->w[i] = qi;
+		uint64_t c = 0, br = 0;   // r -= qi d << 64 i
+		for (uint32_t j = 0; i + j < a->len; ++j) {
+			u128 p = (j < d->len) ? (u128)qi * d->w[j] + c : (u128)c;
+			c = (uint64_t)(p >> 64);
+			uint64_t x = r[i + j], y = (uint64_t)p;
+			r[i + j] = x - y - br;
+			br = (x < y) | ((x == y) & br);
+		}
+	}
+	while (q->len && !q->w[q->len - 1]) --q->len;
+}
+
+static int mp_from_dec(Mp* a, const char* s) {
+	memset(a, 0, sizeof(*a));
+	if (!*s) return 0;
+	for (; *s; ++s) {
+		if (*s < '0' || *s > '9') return 0;
+		uint64_t c = (uint64_t)(*s - '0');
+		for (uint32_t i = 0; i < a->len; ++i) {
+			u128 p = (u128)a->w[i] * 10 + c;
+			a->w[i] = (uint64_t)p;
+			c = (uint64_t)(p >> 64);
+		}
+		if (c) {
+			if (a->len == RHO_MAX_LIMBS) return 0;
+			a->w[a->len++] = c;
+		}
+	}
+	return 1;
+}
+
+static void mp_print(const Mp* a) {
+	uint32_t part[RHO_DEC_MAX / 9 + 1], n = 0;
+	Mp t = *a;
+	do part[n++] = mp_divmod_u32(&t, 1000000000u); while (t.len);
+	printf("%u", part[--n]);
+	while (n) printf("%09u", part[--n]);
+}
+
+// ------------------------------------------------------------
+// Factorization
+// ------------------------------------------------------------
+
+static void rho_push(RhoCtx* cx, const Mp* p) {
+	if (cx->count == cx->cap) {
+		uint32_t cap = cx->cap ? 2 * cx->cap : 64;
+		Mp* f = (Mp*)realloc(cx->f, (size_t)cap * sizeof(Mp));
+		if (!f) { fprintf(stderr, "Out of memory (factors)\n"); exit(2); }
+		cx->f = f;
+		cx->cap = cap;
+	}
+	cx->f[cx->count++] = *p;
+}
+
+// n odd with no prime factor below RHO_TRIAL.
+static void rho_factor(RhoCtx* cx, const Mp* n) {
+	if (n->len == 1 && n->w[0] < (uint64_t)RHO_TRIAL * RHO_TRIAL) { rho_push(cx, n); return; }
+	Mont M;
+	mont_init(&M, n);
+	if (mont_probable_prime(&M)) { rho_push(cx, n); return; }
+	Mp d, q;
+	rho_split(cx, &M, &d);
+	mp_divexact(&q, n, &d);
+	rho_factor(cx, &d);
+	rho_factor(cx, &q);
+}
+
+static int rho_cmp_mp(const void* a, const void* b) {
+	return mp_cmp((const Mp*)a, (const Mp*)b);
+}
+
+static void rho_run(RhoCtx* cx, const char* text) {
+	Mp n;
+	if (!mp_from_dec(&n, text) || !n.len) { printf("%s: error\n", text); return; }
+	cx->count = 0;
+	if (!(n.len == 1 && n.w[0] == 1)) {
+		Mp p;
+		memset(&p, 0, sizeof(p));
+		p.len = 1;
+		p.w[0] = 2;
+		while (!(n.w[0] & 1)) {
+			mp_divmod_u32(&n, 2);
+			rho_push(cx, &p);
+		}
+		for (uint32_t t = 3; t < RHO_TRIAL && n.len; t += 2) {
+			if (n.len == 1 && n.w[0] < (uint64_t)t * t) break;
+			while (mp_mod_u32(&n, t) == 0) {
+				mp_divmod_u32(&n, t);
+				p.w[0] = t;
+				rho_push(cx, &p);
+			}
+		}
+		if (!(n.len == 1 && n.w[0] == 1)) rho_factor(cx, &n);
+	}
+	qsort(cx->f, cx->count, sizeof(Mp), rho_cmp_mp);
+	printf("%s:", text);
+	for (uint32_t i = 0; i < cx->count; ++i) {
+		putchar(' ');
+		mp_print(&cx->f[i]);
+	}
+	putchar('\n');
+	fflush(stdout);
+}
+
+// ------------------------------------------------------------
+// Main
+// ------------------------------------------------------------
+
+int main(int argc, char** argv) {
+	uint32_t threads = 0;
+	int first = argc;
+	for (int a = 1; a < argc; ++a) {
+		if (strncmp(argv[a], "--threads=", 10) == 0) { threads = (uint32_t)strtoul(argv[a] + 10, 0, 10); continue; }
+		if (first == argc) first = a;
+	}
+
+	sys_set_priority(PRIORITY_LOW);
+	sys_memory_init();
+
+	JobSystem js;
+	memset(&js, 0, sizeof(js));
+	uint32_t total = count_total_logical();
+	if (threads == 0 || threads > total) threads = total;
+	js.thread_count = threads;
+
+	if (!jobq_init(&js.jobs, threads)) return 1;
+	for (uint32_t i = 0; i < EPOCH_DEPTH; ++i)
+		if (!event_init(&js.epoch.slot[i].evt_done)) return 1;
+
+	WorkerCtx* w = (WorkerCtx*)calloc(threads, sizeof(WorkerCtx));
+	SysThread* th = (SysThread*)calloc(threads, sizeof(SysThread));
+	if (!w || !th) return 1;
+	stats_init(&js.stats, threads);
+
+	if (!start_workers(&js, w, th)) {
+		fprintf(stderr, "Failed to start workers\n");
+		return 1;
+	}
+	threads = js.thread_count;
+
+	RhoCtx cx;
+	memset(&cx, 0, sizeof(cx));
+	cx.js = &js;
+
+	if (first < argc) {
+		for (int a = first; a < argc; ++a)
+			if (strncmp(argv[a], "--", 2) != 0) rho_run(&cx, argv[a]);
+	}
+	else {
+		static char line[RHO_DEC_MAX + 64];
+		while (fgets(line, sizeof(line), stdin)) {
+			char* s = line;
+			while (*s == ' ' || *s == '\t') ++s;
+			size_t len = strlen(s);
+			while (len && (s[len - 1] == '\n' || s[len - 1] == '\r' || s[len - 1] == ' ')) s[--len] = 0;
+			if (len) rho_run(&cx, s);
+		}
+	}
+
+	stop_workers(&js);
+	wait_all_threads(th, threads);
+	free(th);
+	free(w);
+	for (uint32_t i = 0; i < EPOCH_DEPTH; ++i) event_free(&js.epoch.slot[i].evt_done);
+	jobq_free(&js.jobs);
+	stats_free(&js.stats);
+	free(cx.f);
+	return 0;
+}
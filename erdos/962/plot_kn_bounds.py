@@ -4,7 +4,7 @@ plot_kn_bounds.py
 
 Plots k(n) directly (original Erdős #962 formulation) by inverting the m(k) data:
 
-Given plateau points (k, m(k)) from km_plateaus.csv,
+Given plateau points (k, m(k)) from km_plateaus.csv (or a .kmp file, see kmp.py),
 we plot the "first attainment" points (n=m(k), k) and optionally the step function
 k(n) = max{k : m(k) <= n}.
 
@@ -13,10 +13,15 @@ Also overlays the standard bounds in the same direction:
   - Tang lower:   exp((1/sqrt(2))*sqrt(log n * log log n))  (shape; drop o(1))
   - Tao upper:    sqrt(n)  (shape; drop (1+o(1)))
 
+Curves and the step function are evaluated with NumPy over whole grids (k(n) by
+searchsorted over the m-sorted data). Large inputs, e.g. dense (n, k(n)) samples, are
+min/max-decimated into log-spaced bins before drawing (--decimate).
+
 Usage:
   python plot_kn_bounds.py
   python plot_kn_bounds.py --nmin 1e6 --nmax 1e14 --out kn_focus.png --step
   python plot_kn_bounds.py --erdos-eps 0.1 --erdos-scale 10
+  python plot_kn_bounds.py --csv dense.kmp --step --decimate 4000
 """
 
 import argparse
@@ -26,6 +31,13 @@ from bisect import bisect_right
 from pathlib import Path
 
 import matplotlib.pyplot as plt
+import numpy as np
+
+import kmp
+
+# Inputs above this many points are decimated unless --decimate says otherwise.
+DECIMATE_AUTO_POINTS = 20000
+DECIMATE_AUTO_BINS = 2000
 
 
 def read_plateaus(csv_path: Path):
@@ -33,8 +45,12 @@ def read_plateaus(csv_path: Path):
     Accepts either:
       - headered CSV with columns k,m
       - or two-column CSV without header
+      - or a binary .kmp file (memory-mapped)
     Returns sorted list of (k, m).
     """
+    if kmp.is_kmp(csv_path):
+        return kmp.load_points(csv_path)
+
     rows = []
     with open(csv_path, newline="") as f:
         sample = f.read(4096)
@@ -62,70 +78,120 @@ def read_plateaus(csv_path: Path):
     return rows
 
 
+def read_plateau_arrays(path: Path):
+    """
+    Same inputs as read_plateaus, as NumPy arrays (k, m) sorted by m.
+    A .kmp file is read straight from its mapping, without per-row Python objects.
+    """
+    if kmp.is_kmp(path):
+        with kmp.KmpFile(path) as f:
+            k, m = f.arrays()
+    else:
+        rows = read_plateaus(path)
+        k = np.array([r[0] for r in rows], dtype=np.int64)
+        m = np.array([r[1] for r in rows], dtype=np.float64)
+    order = np.argsort(m, kind="stable")
+    return k[order], m[order]
+
+
 def log_grid(xmin: float, xmax: float, points: int):
     xmin = float(xmin)
     xmax = float(xmax)
     if xmin <= 0 or xmax <= 0 or xmax <= xmin:
-        return [xmin]
+        return np.array([xmin])
+    # keep floats; grid is for smooth curves
+    return np.unique(np.geomspace(xmin, xmax, points + 1))
 
-    lo = math.log(xmin)
-    hi = math.log(xmax)
-    out = []
-    last = None
-    for i in range(points + 1):
-        x = math.exp(lo + (hi - lo) * (i / points))
-        # keep floats; grid is for smooth curves
-        if last is None or x != last:
-            out.append(x)
-            last = x
-    return out
 
+# ---- Bound "shapes" (drop constants / o(1) terms), array-wise ----
 
-# ---- Bound "shapes" (drop constants / o(1) terms) ----
-
-def tao_upper(n: float) -> float:
+def tao_upper(n):
     # k(n) <= (1+o(1))*sqrt(n)  -> plot sqrt(n)
-    return math.sqrt(n)
+    return np.sqrt(n)
 
 
-def tang_lower(n: float) -> float:
+def tang_lower(n):
     # k(n) >= exp((1/sqrt(2)-o(1))*sqrt(log n log log n))
     # -> plot exp((1/sqrt(2))*sqrt(log n log log n)) for n>e^e
-    if n <= math.e ** math.e:
-        return float("nan")
-    L = math.log(n)
-    return math.exp((1.0 / math.sqrt(2.0)) * math.sqrt(L * math.log(L)))
+    n = np.asarray(n, dtype=np.float64)
+    with np.errstate(invalid="ignore", divide="ignore"):
+        L = np.log(n)
+        v = np.exp((1.0 / math.sqrt(2.0)) * np.sqrt(L * np.log(L)))
+    return np.where(n > math.e ** math.e, v, np.nan)
 
 
-def erdos_lower(n: float, eps: float, scale: float) -> float:
+def erdos_lower(n, eps: float, scale: float):
     # Erdős: k(n) >>_eps exp((log n)^(1/2 - eps))
     # -> plot scale * exp((log n)^(1/2 - eps))
-    if n <= 1.0:
-        return float("nan")
-    L = math.log(n)
+    n = np.asarray(n, dtype=np.float64)
     power = 0.5 - eps
     if power <= 0:
-        return float("nan")
-    return scale * math.exp(L ** power)
+        return np.full(n.shape, np.nan)
+    with np.errstate(invalid="ignore", divide="ignore"):
+        v = scale * np.exp(np.log(n) ** power)
+    return np.where(n > 1.0, v, np.nan)
 
 
 # ---- k(n) from m(k) plateau data ----
 
-def k_of_n_from_mk(n: float, mk_sorted_by_m):
+def k_of_n_from_mk(n: float, mk_sorted_by_m, ms=None):
     """
     mk_sorted_by_m: list of (m, k) sorted by m increasing
+    ms: [m for (m, k) in mk_sorted_by_m], precomputed when querying repeatedly
     returns max k such that m(k) <= n (step function)
     """
-    ms = [mk[0] for mk in mk_sorted_by_m]
+    if ms is None:
+        ms = [mk[0] for mk in mk_sorted_by_m]
     idx = bisect_right(ms, n) - 1
     if idx < 0:
         return 0
     return mk_sorted_by_m[idx][1]
 
 
+def k_of_n_array(n, m_sorted, k_sorted):
+    """
+    Vectorized k_of_n_from_mk: max k with m(k) <= n for every n, 0 where none.
+    m_sorted: m increasing, k_sorted: the matching k.
+    """
+    idx = np.searchsorted(m_sorted, n, side="right") - 1
+    return np.where(idx >= 0, k_sorted[np.maximum(idx, 0)], 0)
+
+
+def decimate_minmax(m_sorted, k_sorted, nmin: float, nmax: float, bins: int):
+    """
+    Min/max decimation over `bins` log-spaced bins of [nmin, nmax].
+    Returns (x, y) for a steps-post line: per non-empty bin, (first m, min k) and
+    (last m, max k), framed by the step value at nmin and nmax; and the indices of the
+    records kept as markers (first and last of each bin). A non-decreasing step
+    function comes out exact at bin resolution.
+    """
+    lo = np.searchsorted(m_sorted, max(nmin, np.nextafter(0.0, 1.0)), side="left")
+    hi = np.searchsorted(m_sorted, nmax, side="right")
+    m = m_sorted[lo:hi]
+    k = k_sorted[lo:hi]
+    k0 = k_of_n_array(np.array([nmin]), m_sorted, k_sorted)[0]
+    if m.size == 0:
+        return np.array([nmin, nmax]), np.array([k0, k0]), np.arange(0)
+
+    a, b = math.log(nmin if nmin > 0 else m[0]), math.log(nmax)
+    span = (b - a) if b > a else 1.0
+    bin_of = np.clip(((np.log(m) - a) / span * bins).astype(np.int64), 0, bins - 1)
+    starts = np.flatnonzero(np.r_[True, bin_of[1:] != bin_of[:-1]])
+    ends = np.r_[starts[1:], m.size] - 1
+
+    x = np.empty(2 * starts.size + 2)
+    y = np.empty(2 * starts.size + 2, dtype=k.dtype)
+    x[0], y[0] = nmin, k0
+    x[1:-1:2], y[1:-1:2] = m[starts], np.minimum.reduceat(k, starts)
+    x[2:-1:2], y[2:-1:2] = m[ends], np.maximum.reduceat(k, starts)
+    x[-1], y[-1] = nmax, y[-2]
+    keep = np.unique(np.r_[starts, ends]) + lo
+    return x, y, keep
+
+
 def main():
     ap = argparse.ArgumentParser()
-    ap.add_argument("--csv", default="km_plateaus.csv", help="Input CSV with plateau points k,m")
+    ap.add_argument("--csv", default="km_plateaus.csv", help="Input CSV with plateau points k,m (or a .kmp file)")
     ap.add_argument("--out", default="kn_bounds.png", help="Output PNG path")
     ap.add_argument("--nmin", type=float, default=None, help="Min n to plot (default: min m in data)")
     ap.add_argument("--nmax", type=float, default=None, help="Max n to plot (default: max m in data)")
@@ -138,22 +204,23 @@ def main():
     ap.add_argument("--erdos-eps", type=float, default=0.1, help="Epsilon for Erdős lower bound shape")
     ap.add_argument("--erdos-scale", type=float, default=1.0, help="Vertical scale for Erdős curve (implicit constant)")
     ap.add_argument("--step", action="store_true", help="Also plot step-function k(n)=max{k:m(k)<=n}")
+    ap.add_argument("--decimate", type=int, default=None, metavar="BINS",
+                    help="Min/max-decimate data points and --step into BINS log-spaced bins "
+                         f"(0: off; default: {DECIMATE_AUTO_BINS} above {DECIMATE_AUTO_POINTS} points)")
     ap.add_argument("--title", default="Erdős #962: k(n) from inverted m(k) data with bounds (direct orientation)")
     args = ap.parse_args()
 
-    pts_km = read_plateaus(Path(args.csv))
-    if not pts_km:
+    # Invert data as (n=m, k) "first attainment" points, sorted by m for the step function
+    k_data, n_data = read_plateau_arrays(Path(args.csv))
+    if n_data.size == 0:
         raise SystemExit("No data loaded.")
 
-    # Invert data as (n=m, k) "first attainment" points
-    n_data = [m for (k, m) in pts_km]
-    k_data = [k for (k, m) in pts_km]
-
-    nmin = args.nmin if args.nmin is not None else float(min(n_data))
-    nmax = args.nmax if args.nmax is not None else float(max(n_data))
+    nmin = args.nmin if args.nmin is not None else float(n_data[0])
+    nmax = args.nmax if args.nmax is not None else float(n_data[-1])
 
-    # For step function: sort by m
-    mk_sorted_by_m = sorted([(m, k) for (k, m) in pts_km], key=lambda x: x[0])
+    bins = args.decimate
+    if bins is None:
+        bins = DECIMATE_AUTO_BINS if n_data.size > DECIMATE_AUTO_POINTS else 0
 
     # Smooth grid for bounds (float)
     grid = log_grid(nmin, nmax, args.grid)
@@ -161,23 +228,30 @@ def main():
     plt.figure(figsize=(9, 6))
 
     # data points
-    plt.loglog(n_data, k_data, marker="o", linestyle="None", label="Data (inverted): points (n=m(k), k)")
-
-    # step function sampling
+    if bins > 0:
+        x_step, k_step, keep = decimate_minmax(n_data, k_data, nmin, nmax, bins)
+        plt.loglog(n_data[keep], k_data[keep], marker="o", linestyle="None", markersize=3,
+                   label=f"Data (inverted): points (n=m(k), k), min/max of {bins} bins")
+    else:
+        plt.loglog(n_data, k_data, marker="o", linestyle="None", label="Data (inverted): points (n=m(k), k)")
+
+    # step function: exact at bin resolution when decimating, else sampled on the grid
     if args.step:
-        k_step = [k_of_n_from_mk(x, mk_sorted_by_m) for x in grid]
-        plt.loglog(grid, k_step, label="Step function: k(n)=max{k: m(k)≤n}")
+        if bins > 0:
+            plt.loglog(x_step, k_step, drawstyle="steps-post", label="Step function: k(n)=max{k: m(k)≤n}")
+        else:
+            plt.loglog(grid, k_of_n_array(grid, n_data, k_data), label="Step function: k(n)=max{k: m(k)≤n}")
 
     if not args.no_tao:
-        plt.loglog(grid, [tao_upper(x) for x in grid], label="Tao upper (shape): k(n) ≈ √n")
+        plt.loglog(grid, tao_upper(grid), label="Tao upper (shape): k(n) ≈ √n")
 
     if not args.no_tang:
-        plt.loglog(grid, [tang_lower(x) for x in grid], label="Tang lower (shape): exp((1/√2)√(log n log log n))")
+        plt.loglog(grid, tang_lower(grid), label="Tang lower (shape): exp((1/√2)√(log n log log n))")
 
     if not args.no_erdos:
         plt.loglog(
             grid,
-            [erdos_lower(x, args.erdos_eps, args.erdos_scale) for x in grid],
+            erdos_lower(grid, args.erdos_eps, args.erdos_scale),
             label=f"Erdős lower (shape): scale·exp((log n)^(1/2-ε)), ε={args.erdos_eps:g}",
         )
 
@@ -2,19 +2,15 @@
 
 ; We make any assumption that helps simplify the code:
 ;	+ Single ABI frame, rest are leaf functions.
-;	+ Input data is less than 1MB.
+;	+ Input is a read-only file mapping: any size, constant memory.
 ;	+ Data consists of lines starting: {#}, {#}.
 ;	- Allow filename on the command line.
 ;	- Of course, it can break easily, but also easy to fix.
 
 include 'console.inc'
 
-; 1MB Buffer + 64KB safety margin (shadow space, logic stack, etc.)
-STACK_BUFFER_SIZE = 1024 * 1024 
-STACK_TOTAL       = STACK_BUFFER_SIZE + 65536
-
-; Request OS to reserve and commit this space immediately.
-stack STACK_TOTAL, STACK_TOTAL
+; Output line only: wsprintfA never writes more than 1024 bytes.
+OUT_BUFFER_SIZE = 1024
 
 start:
 	enter .frame, 0
@@ -23,18 +19,21 @@ start:
 		.hStdOut	dq ?	; HANDLE
 		.hFile		dq ?	; HANDLE
 		.NumArgs	dd ?	; u32
-		.bytesRead	dd ?	; u32
 
 		label .result:4 at .NumArgs	; BOOL
 
 		assert $-$$ <= 32 ; shadow space limitation
 	end virtual
 
-	sub rsp, STACK_BUFFER_SIZE
+	sub rsp, OUT_BUFFER_SIZE + 16
 	virtual at rsp + .frame
-		.file_buffer rb STACK_BUFFER_SIZE
+		.fileSize	dq ?	; u64
+				dq ?
+		.out_buffer	rb OUT_BUFFER_SIZE
 	end virtual
 
+	xor edi, edi			; no view yet
+
 	invoke GetStdHandle, STD_OUTPUT_HANDLE
 	mov [.hStdOut], rax
 
@@ -51,34 +50,43 @@ start:
 .default_filename:
 	mov [.result], 1 ; assume error
 
-	invoke CreateFileW, rcx, GENERIC_READ, FILE_SHARE_READ, 0, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, 0
+	invoke CreateFileW, rcx, GENERIC_READ, FILE_SHARE_READ, 0, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, 0
 	lea r8, [GLOB('could not open file')]
 	cmp rax, INVALID_HANDLE_VALUE
 	jz .err
 	mov [.hFile], rax
 
-	lea rsi, [.file_buffer]
-	invoke ReadFile, [.hFile], rsi, STACK_BUFFER_SIZE, addr .bytesRead, 0
-	lea r8, [GLOB('ReadFile failed')]
-	test eax, eax ; BOOL
-	jz .err
+	invoke GetFileSize, [.hFile], addr .fileSize + 4
+	mov dword [.fileSize], eax
 
-	mov eax, [.bytesRead]
-	lea r8, [GLOB('file too large for buffer')]
-	cmp eax, STACK_BUFFER_SIZE
+	lea r8, [GLOB('file empty')]	; (an empty file cannot be mapped)
+	cmp qword [.fileSize], 0
 	jz .err
 
-	lea r8, [GLOB('file empty')]
-	test eax, eax
+	invoke CreateFileMappingW, [.hFile], 0, PAGE_READONLY, 0, 0, 0
+	lea r8, [GLOB('CreateFileMapping failed')]
+	test rax, rax
 	jz .err
-	mov qword [rsi + rax], 0 ; null-terminate the buffer
+	xchg rbx, rax			; RBX = mapping
 
+	; the mapping holds its own reference to the file, and the view to the mapping
 	invoke CloseHandle, [.hFile]
+	invoke MapViewOfFile, rbx, FILE_MAP_READ, 0, 0, 0
+	xchg rdi, rax			; RDI = view, kept for UnmapViewOfFile
+	invoke CloseHandle, rbx
+	lea r8, [GLOB('MapViewOfFile failed')]
+	test rdi, rdi
+	jz .err
+
+	mov rsi, rdi
+	mov r15, rdi
+	add r15, [.fileSize]		; R15 = end of data (no terminator in a view)
 
 ; Line reader loop:
 ;   + any line not starting with two comma-separated numbers is ignored
 ;   + bytes afterward [until the end of line] are ignored
 ;   + whitespace/comma around numbers is ignored
+;   + pages of the view are touched once, in order; nothing is copied
 .parse_loop:
 	call parse_uint			; parse k
 	jc .skip_line
@@ -92,28 +100,34 @@ start:
 	jnc .parse_loop
 
 .verify_fail:
-	invoke wsprintfA, addr .file_buffer, addr _t_fail, r12, r13, r14
+	invoke wsprintfA, addr .out_buffer, addr _t_fail, r12, r13, r14
 	jmp .out
 
-.err:	invoke wsprintfA, addr .file_buffer, addr _t_err, r8
+.err:	invoke wsprintfA, addr .out_buffer, addr _t_err, r8
 	jmp .out
 
 ; If parse failed (e.g., header row), skip to next line (any newline arrangement okay):
 .skip_line:
+	cmp rsi, r15
+	jnc .done_all		; end of data
 	lodsb
 	cmp al, 13		; CR
 	jz .parse_loop
 	cmp al, 10		; LF
 	jz .parse_loop
-	test al, al
-	jnz .skip_line
+	jmp .skip_line
 
 .done_all:
 	mov [.result], 0 ; success
-	invoke wsprintfA, addr .file_buffer, addr _t_str, 'All values check out'
+	invoke wsprintfA, addr .out_buffer, addr _t_str, 'All values check out'
 
 .out:	xchg r8d, eax
-	invoke WriteFile, [.hStdOut], addr .file_buffer, r8, 0, 0
+	invoke WriteFile, [.hStdOut], addr .out_buffer, r8, 0, 0
+
+	test rdi, rdi
+	jz @F
+	invoke UnmapViewOfFile, rdi
+@@:
 
 	mov rcx, [.ArgList]
 	jrcxz @F
@@ -134,9 +148,9 @@ _t_str	GLOBSTR '%s.',13,10,0
 parse_uint:
 	xor eax, eax
 	xor ecx, ecx
-.ctrl:	lodsb
-	test al, al
-	jz .err
+.ctrl:	cmp rsi, r15
+	jnc .end		; Y: out of data
+	lodsb
 	cmp al, ' '+1
 	jc .ctrl		; Y: consume ALL control chars and space
 	cmp al, ','
@@ -151,17 +165,19 @@ parse_uint:
 .more:	imul rcx, rcx, 10
 	add rcx, rax
 
-; At this point a non-digit signals end of number
+; At this point a non-digit (or the end of data) signals end of number
 
+	cmp rsi, r15
+	jnc .num		; CF=0
 	lodsb
 	sub al, '0'
 	cmp al, 10
 	jc .more
 	dec rsi			; restore unprocessed character
-	retn
+.num:	retn
 
 .err:	dec rsi			; restore unprocessed character
-	stc			; not-a-number, probably header/comment/eof
+.end:	stc			; not-a-number, probably header/comment/eof
 	retn
 
 
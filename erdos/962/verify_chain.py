@@ -1,12 +1,48 @@
+import atexit
+import os
+import subprocess
 import sys
 import time
 
+from kmp import load_points
+
+_rho = None
+
+def _rho_pipe():
+    """mk_rho (mk_rho.c, Brent-Pollard rho on the mk thread pool) on a pipe, if it is built next to this script."""
+    global _rho
+    if _rho is None:
+        _rho = False
+        here = os.path.dirname(os.path.abspath(__file__))
+        for name in ("mk_rho.exe", "mk_rho"):
+            path = os.path.join(here, name)
+            if os.path.isfile(path):
+                _rho = subprocess.Popen([path], stdin=subprocess.PIPE, stdout=subprocess.PIPE,
+                                        text=True, bufsize=1)
+                atexit.register(_rho_close)
+                break
+    return _rho
+
+def _rho_close():
+    # EOF on stdin ends mk_rho's read loop
+    _rho.stdin.close()
+    _rho.wait()
+
 def get_prime_factors_map(n):
     """
-    Returns a set of prime factors for n. 
-    Not efficient for huge numbers, but we only care about small factors 
-    up to the plateau size (e.g. ~5000), so we stop looking early.
+    Returns a set of prime factors for n, from mk_rho when it is built here
+    (one "n" line in, one "n: p1 p2 ..." line out). Without it, trial
+    division: fine for the m of the CSV, hopeless for large factors.
     """
+    rho = _rho_pipe()
+    if rho and n > 1:
+        rho.stdin.write(f"{n}\n")
+        rho.stdin.flush()
+        head, _, primes = rho.stdout.readline().partition(":")
+        if head != str(n) or "error" in primes:
+            raise ValueError(f"mk_rho could not factor {n}")
+        return {int(p) for p in primes.split()}
+
     factors = set()
     d = 2
     temp = n
@@ -41,6 +77,9 @@ def measure_true_length(k_start, m):
     1. Initialize array of values [m+1 ... m+limit]
     2. Strip factors <= k_start
     3. Incrementally increase z, stripping new prime factors as z grows.
+
+    Returns (z, i): i is the index whose residue reached 1 and ended the
+    plateau, so P(m+i) <= z+1 (i is 0 with the -1 / -2 sentinels).
     """
     
     # Heuristic: We don't expect the true length to be MASSIVELY larger 
@@ -84,7 +123,7 @@ def measure_true_length(k_start, m):
     # 2. Check base validity (1..k_start)
     for i in range(1, k_start + 1):
         if residues[i] == 1:
-            return -1 # Should not happen if CSV is valid
+            return -1, 0 # Should not happen if CSV is valid
 
     # 3. Extend z
     current_z = k_start
@@ -92,7 +131,7 @@ def measure_true_length(k_start, m):
     while True:
         next_z = current_z + 1
         if next_z > limit:
-            return -2 # Buffer limit reached (plateau is huge!)
+            return -2, 0 # Buffer limit reached (plateau is huge!)
 
         # A. If next_z is prime, strip it from previous residues 1..current_z
         if is_prime(next_z):
@@ -112,13 +151,13 @@ def measure_true_length(k_start, m):
                 # If residue became 1, it means all factors were <= next_z.
                 # So P(m+i) <= next_z. FAIL condition met.
                 if i <= current_z and residues[i] == 1:
-                    return current_z # The expansion failed, true size is current_z
+                    return current_z, i # The expansion failed, true size is current_z
 
         # B. Check the new item at index next_z
         # It has been stripped of all primes <= next_z (by the loop above and previous steps).
         # If it is 1, it fails.
         if residues[next_z] == 1:
-            return current_z
+            return current_z, next_z
 
         current_z = next_z
 
@@ -129,15 +168,8 @@ def main():
 
     print(f"Verifying chain coverage in {filename}...")
     
-    data = []
     try:
-        with open(filename, 'r') as f:
-            for line in f:
-                parts = line.split(',')
-                if len(parts) >= 2 and parts[0].strip().isdigit():
-                    k = int(parts[0])
-                    m = int(parts[1])
-                    data.append((k, m))
+        data = load_points(filename)  # CSV or .kmp
     except FileNotFoundError:
         print("File not found.")
         return
@@ -149,12 +181,13 @@ def main():
 
     start_time = time.time()
     gaps = 0
+    fails = 0
 
     for i in range(len(data)):
         k, m = data[i]
         
         # Calculate how far this plateau *really* goes
-        true_len = measure_true_length(k, m)
+        true_len, brk = measure_true_length(k, m)
         
         if true_len == -1:
             print(f"{k:<10} | {'INVALID':<15} | {'-':<10} | FAIL (Base k invalid)")
@@ -182,13 +215,21 @@ def main():
         else:
             status = "FINAL"
 
+        # With mk_rho, factor the value that ended the plateau independently
+        # of the sieve: it must be (true_len+1)-smooth
+        if brk and _rho_pipe() and max(get_prime_factors_map(m + brk)) > true_len + 1:
+            status = f"FAIL (m+{brk} is not {true_len + 1}-smooth)"
+            fails += 1
+
         # Only print gaps or every 500th line to avoid spamming console
-        if status.startswith("GAP") or i % 500 == 0 or i == len(data)-1:
+        if status.startswith(("GAP", "FAIL")) or i % 500 == 0 or i == len(data)-1:
             print(f"{k:<10} | {true_len:<15} | {next_k_str:<10} | {status}")
 
     duration = time.time() - start_time
     print("-" * 60)
-    if gaps == 0:
+    if fails:
+        print(f"Verification Failed: {fails} plateau ends not confirmed by mk_rho.")
+    elif gaps == 0:
         print(f"Chain Verified: Complete continuous coverage found.")
     else:
         print(f"Verification Complete: {gaps} gaps found.")
@@ -0,0 +1,490 @@
+// A000043.c
+//
+// Lucas-Lehmer test of 2^P - 1 for a list of exponents (the known A000043 terms by default),
+// one exponent at a time per worker of the mk thread pool: ../erdos/962/
+// mk_iocp_tiled_sieve_strided_fastdiv.c is included whole, without its main, and its
+// workers run EPOCH_TASK lanes here.
+// - S -> S^2 - 2 (mod 2^P - 1) by an irrational-base discrete weighted transform (Crandall,
+//   Fagin): S in N balanced digits of floor(P/N) or ceil(P/N) bits, digit j weighted by
+//   2^(ceil(jP/N) - jP/N), so the plain cyclic convolution of length N is already the
+//   square mod 2^P - 1. The 2^n-1 fold of mod_special.g (and of Lucas_Lehmer_Test in
+//   A000043.Mersenne.g) is the carry out of the top digit wrapping into digit 0
+// - The real length-N convolution is a complex FFT of length N/2 on packed even/odd digits:
+//   radix 2, decimation in frequency into bit-reversed order and in time back out, so no
+//   permutation pass; the squaring step pairs bins k and N/2-k through a reversal table
+// - Every product digit is checked on rounding: a distance over LL_MAX_ERR redoes the
+//   exponent at twice the length. P < 64 squares in u128 with the .g fold instead
+// - Largest exponent first (a shared countdown), so the long tests start at once and the
+//   short ones fill the other workers; FFT buffers come from the worker's NUMA node
+//
+// Output, one line per exponent as it finishes (any order), then a summary:
+//   P, prime|composite, res64, N, max_err, seconds
+// res64 is S(P-2) mod 2^P - 1, low 64 bits, in hex (0 exactly when 2^P - 1 is prime).
+//
+// Build (Linux / POSIX):
+//   cc -O3 -std=c11 -march=native A000043.c -o ll -lpthread -lm
+//
+// Build (clang, in VS dev prompt):
+//   clang -O3 -std=c11 -march=native A000043.c -o ll.exe -lkernel32 -ladvapi32 -lws2_32 -fuse-ld=lld
+//
+// Usage:
+//   ll [P_max=44497] [threads=0=HW] [--p=P1,P2,...]
+//
+//   P_max     test the known Mersenne prime exponents up to P_max; exits 1 if one fails
+//   --p       test these exponents instead (res64 identifies a composite)
+
+#define MK_NO_MAIN
+#if defined(__clang__) || defined(__GNUC__)
+#pragma GCC diagnostic ignored "-Wunused-function"   // the search driver is not called here
+#endif
+#include "../erdos/962/mk_iocp_tiled_sieve_strided_fastdiv.c"
+
+#ifndef LL_MAX_ERR
+#define LL_MAX_ERR 0.40   // largest rounding distance accepted in a product digit
+#endif
+#ifndef LL_MAX_LIST
+#define LL_MAX_LIST 4096
+#endif
+
+static const uint32_t ll_known[] = {
+	2, 3, 5, 7, 13, 17, 19, 31, 61, 89, 107, 127, 521, 607, 1279, 2203, 2281, 3217, 4253, 4423,
+	9689, 9941, 11213, 19937, 21701, 23209, 44497, 86243, 110503, 132049, 216091, 756839,
+	859433, 1257787, 1398269, 2976221, 3021377, 6972593, 13466917, 20996011, 24036583,
+	25964951, 30402457, 32582657, 37156667, 42643801, 43112609, 57885161, 74207281,
+	77232917, 82589933
+};
+#define LL_KNOWN_COUNT (sizeof(ll_known) / sizeof(ll_known[0]))
+
+typedef struct LLJob {
+	uint32_t p;
+	uint32_t n;         // transform length used (0: u128 path)
+	uint32_t known;     // in ll_known: must come out prime
+	uint32_t prime;
+	uint64_t res64;
+	double   err;       // largest rounding distance seen
+	double   sec;
+} LLJob;
+
+typedef struct LLRun {
+	LLJob*     job;     // increasing p
+	uint32_t   count;
+	shared_u32 left;    // countdown: the next job to take is left - 1
+} LLRun;
+
+// ------------------------------------------------------------
+// Small exponents: the .g macro in u128
+// ------------------------------------------------------------
+
+static uint64_t ll_small(uint32_t p) {
+	uint64_t m = (p == 64) ? UINT64_MAX : (1ull << p) - 1;
+	uint64_t s = 4 % m;
+	for (uint32_t i = 2; i < p; ++i) {
+		u128 t = (u128)s * s + m - 2;   // + m keeps it positive
+		while (t > m) t = (t & m) + (t >> p);
+		s = (t == m) ? 0 : (uint64_t)t;
+	}
+	return s;
+}
+
+// ------------------------------------------------------------
+// Transform state of one exponent
+// ------------------------------------------------------------
+
+typedef struct LLState {
+	uint32_t p, n, h;   // exponent, digits, complex length n/2
+	double*  z;         // [2h] interleaved: digits 2j, 2j+1 as re, im (weighted)
+	double*  tw;        // [2h] stage tables: [m + k] = e^(-2 pi i k / 2m), k < m, m = 1, 2, 4 .. h/2
+	double*  wt;        // [n] 2^(ceil(jp/n) - jp/n)
+	double*  iwt;       // [n] 1 / (wt * h)
+	int32_t* d;         // [n] balanced digits
+	uint8_t* bits;      // [n] digit widths
+	uint32_t* rev;      // [h] bit reversal
+} LLState;
+
+// Bits per digit a length may carry: the convolution sums h products of two balanced
+// digits, whose rounding error grows with sqrt(n) (Crandall, Fagin; GIMPS practice).
+static uint32_t ll_bits_max(uint32_t n) {
+	uint32_t lg = 0;
+	while ((1u << lg) < n) ++lg;
+	return (uint32_t)((48.0 - 0.5 * lg) / 2.0);
+}
+
+static uint32_t ll_length_for(uint32_t p) {
+	uint32_t n = 8;
+	while ((p + n - 1) / n > ll_bits_max(n)) n <<= 1;
+	return n;
+}
+
+static void ll_free(LLState* s) {
+	sys_free(s->z); sys_free(s->tw); sys_free(s->wt); sys_free(s->iwt);
+	sys_free(s->d); sys_free(s->bits); sys_free(s->rev);
+	memset(s, 0, sizeof(*s));
+}
+
+static void ll_init(LLState* s, uint32_t p, uint32_t n, uint32_t node) {
+	memset(s, 0, sizeof(*s));
+	s->p = p;
+	s->n = n;
+	s->h = n / 2;
+	uint32_t h = s->h;
+
+	s->z = (double*)sys_alloc_node((size_t)2 * h * sizeof(double), node);
+	s->tw = (double*)sys_alloc_node((size_t)2 * h * sizeof(double), node);
+	s->wt = (double*)sys_alloc_node((size_t)n * sizeof(double), node);
+	s->iwt = (double*)sys_alloc_node((size_t)n * sizeof(double), node);
+	s->d = (int32_t*)sys_alloc_node((size_t)n * sizeof(int32_t), node);
+	s->bits = (uint8_t*)sys_alloc_node(n, node);
+	s->rev = (uint32_t*)sys_alloc_node((size_t)h * sizeof(uint32_t), node);
+	if (!s->z || !s->tw || !s->wt || !s->iwt || !s->d || !s->bits || !s->rev) {
+		fprintf(stderr, "alloc failed for LL buffers (p=%u, n=%u)\n", p, n);
+		exit(2);
+	}
+
+	const double two_pi = 6.283185307179586476925286766559;
+	for (uint32_t m = 1; m < h; m <<= 1) {
+		for (uint32_t k = 0; k < m; ++k) {
+			s->tw[2 * (m + k)] = cos(two_pi * k / (2.0 * m));
+			s->tw[2 * (m + k) + 1] = -sin(two_pi * k / (2.0 * m));
+		}
+	}
+
+	uint32_t lg = 0;
+	while ((1u << lg) < h) ++lg;
+	for (uint32_t k = 0; k < h; ++k) {
+		uint32_t r = 0;
+		for (uint32_t b = 0; b < lg; ++b) r |= ((k >> b) & 1u) << (lg - 1 - b);
+		s->rev[k] = r;
+	}
+
+	// digit j covers bits ceil(jp/n) .. ceil((j+1)p/n) - 1; its weight exponent is the
+	// fraction (ceil(jp/n) * n - jp) / n, exact in integers
+	uint64_t at = 0;
+	for (uint32_t j = 0; j < n; ++j) {
+		uint64_t next = ((uint64_t)(j + 1) * p + n - 1) / n;
+		s->bits[j] = (uint8_t)(next - at);
+		double f = (double)(at * n - (uint64_t)j * p) / n;
+		s->wt[j] = exp2(f);
+		s->iwt[j] = exp2(-f) / h;
+		at = next;
+	}
+
+	memset(s->d, 0, (size_t)n * sizeof(int32_t));
+	s->d[0] = 4;
+	for (uint32_t j = 0; j < n; ++j) s->z[j] = s->d[j] * s->wt[j];
+}
+
+// ------------------------------------------------------------
+// FFT of length h (radix 2)
+// ------------------------------------------------------------
+
+// natural order in, bit-reversed out
+static void ll_fft_dif(double* z, const double* tw, uint32_t h) {
+	for (uint32_t len = h; len >= 2; len >>= 1) {
+		uint32_t half = len / 2;
+		const double* t = tw + 2 * half;
+		for (uint32_t s = 0; s < h; s += len) {
+			double* a = z + 2 * s;
+			double* b = a + 2 * half;
+			for (uint32_t k = 0; k < half; ++k) {
+				double wr = t[2 * k], wi = t[2 * k + 1];
+				double ur = a[2 * k], ui = a[2 * k + 1];
+				double vr = b[2 * k], vi = b[2 * k + 1];
+				a[2 * k] = ur + vr;
+				a[2 * k + 1] = ui + vi;
+				double tr = ur - vr, ti = ui - vi;
+				b[2 * k] = tr * wr - ti * wi;
+				b[2 * k + 1] = tr * wi + ti * wr;
+			}
+		}
+	}
+}
+
+// bit-reversed in, natural order out, conjugate twiddles (unscaled)
+static void ll_fft_dit_inv(double* z, const double* tw, uint32_t h) {
+	for (uint32_t len = 2; len <= h; len <<= 1) {
+		uint32_t half = len / 2;
+		const double* t = tw + 2 * half;
+		for (uint32_t s = 0; s < h; s += len) {
+			double* a = z + 2 * s;
+			double* b = a + 2 * half;
+			for (uint32_t k = 0; k < half; ++k) {
+				double wr = t[2 * k], wi = -t[2 * k + 1];
+				double vr = b[2 * k] * wr - b[2 * k + 1] * wi;
+				double vi = b[2 * k] * wi + b[2 * k + 1] * wr;
+				double ur = a[2 * k], ui = a[2 * k + 1];
+				a[2 * k] = ur + vr;
+				a[2 * k + 1] = ui + vi;
+				b[2 * k] = ur - vr;
+				b[2 * k + 1] = ui - vi;
+			}
+		}
+	}
+}
+
+// Square the real signal whose packed transform is Z (bit-reversed). With E, O the
+// transforms of the even and odd digits, E_k = (Z_k + conj Z_{h-k}) / 2 and
+// O_k = (Z_k - conj Z_{h-k}) / 2i; the packed transform of the square is then
+// E_k^2 + t^k O_k^2 + 2i E_k O_k with t = e^(-2 pi i / h), and bin h-k uses the conjugates.
+static void ll_square_bins(LLState* s) {
+	double* z = s->z;
+	const uint32_t* rev = s->rev;
+	uint32_t h = s->h;
+
+	for (uint32_t k = 0; k <= h / 2; ++k) {
+		uint32_t j = (h - k) & (h - 1);
+		double* zk = z + 2 * rev[k];
+		double* zj = z + 2 * rev[j];
+
+		if (j == k) {   // bins 0 and h/2: t^k is 1 and -1
+			double a = zk[0], b = zk[1];
+			zk[0] = (k == 0) ? a * a + b * b : a * a - b * b;
+			zk[1] = 2 * a * b;
+			continue;
+		}
+
+		double er = 0.5 * (zk[0] + zj[0]), ei = 0.5 * (zk[1] - zj[1]);
+		double or_ = 0.5 * (zk[1] + zj[1]), oi = -0.5 * (zk[0] - zj[0]);
+		double tr = s->tw[h + 2 * k], ti = s->tw[h + 2 * k + 1];   // stage m = h/2
+
+		double e2r = er * er - ei * ei, e2i = 2 * er * ei;
+		double o2r = or_ * or_ - oi * oi, o2i = 2 * or_ * oi;
+		double eor = er * or_ - ei * oi, eoi = er * oi + ei * or_;
+		double to_r = tr * o2r - ti * o2i, to_i = tr * o2i + ti * o2r;
+
+		// bin k, then bin j from conj(E_k), conj(O_k) and conj(t^k)
+		zk[0] = e2r + to_r - 2 * eoi;
+		zk[1] = e2i + to_i + 2 * eor;
+		zj[0] = e2r + to_r + 2 * eoi;
+		zj[1] = -e2i - to_i + 2 * eor;
+	}
+}
+
+// Round the product digits, subtract 2, carry into balanced digits (the top carry wraps:
+// 2^p = 1), and reweight into z for the next square. Returns the largest rounding distance.
+static double ll_carry(LLState* s) {
+	uint32_t n = s->n;
+	double* z = s->z;
+	double err = 0.0;
+	int64_t carry = -2;
+
+	for (uint32_t j = 0; j < n; ++j) {
+		double c = z[j] * s->iwt[j];
+		double r = nearbyint(c);
+		double e = fabs(c - r);
+		if (e > err) err = e;
+
+		uint32_t b = s->bits[j];
+		int64_t v = (int64_t)r + carry;
+		int64_t half = 1ll << (b - 1);
+		int64_t dig = ((v + half) & ((1ll << b) - 1)) - half;
+		carry = (v - dig) >> b;
+		s->d[j] = (int32_t)dig;
+	}
+	for (uint32_t j = 0; carry; j = (j + 1 == n) ? 0 : j + 1) {
+		uint32_t b = s->bits[j];
+		int64_t v = s->d[j] + carry;
+		int64_t half = 1ll << (b - 1);
+		int64_t dig = ((v + half) & ((1ll << b) - 1)) - half;
+		carry = (v - dig) >> b;
+		s->d[j] = (int32_t)dig;
+	}
+
+	for (uint32_t j = 0; j < n; ++j) z[j] = s->d[j] * s->wt[j];
+	return err;
+}
+
+// S mod 2^p - 1 from the balanced digits: non-negative digits with the wrapped carry, then
+// the low 64 bits (0 when every digit is full, i.e. S = 2^p - 1).
+static uint64_t ll_res64(LLState* s) {
+	uint32_t n = s->n;
+	int64_t carry = 0;
+	for (int pass = 0; pass == 0 || carry; ++pass) {
+		for (uint32_t j = 0; j < n; ++j) {
+			uint32_t b = s->bits[j];
+			int64_t v = s->d[j] + carry;
+			int64_t dig = v & ((1ll << b) - 1);
+			carry = (v - dig) >> b;
+			s->d[j] = (int32_t)dig;
+		}
+	}
+
+	int full = 1;
+	for (uint32_t j = 0; j < n && full; ++j) full = (s->d[j] == (1 << s->bits[j]) - 1);
+	if (full) return 0;
+
+	uint64_t r = 0;
+	uint32_t at = 0;
+	for (uint32_t j = 0; j < n && at < 64; at += s->bits[j], ++j) r |= (uint64_t)s->d[j] << at;
+	return r;
+}
+
+// p - 2 squarings at length n; 0 if a rounding went past LL_MAX_ERR (the caller doubles n).
+static int ll_run(LLJob* job, uint32_t n, uint32_t node) {
+	LLState s;
+	ll_init(&s, job->p, n, node);
+
+	double err = 0.0;
+	for (uint32_t i = 2; i < job->p; ++i) {
+		ll_fft_dif(s.z, s.tw, s.h);
+		ll_square_bins(&s);
+		ll_fft_dit_inv(s.z, s.tw, s.h);
+		double e = ll_carry(&s);
+		if (e > err) err = e;
+		if (err > LL_MAX_ERR) break;
+	}
+
+	int ok = (err <= LL_MAX_ERR);
+	if (ok) {
+		job->res64 = ll_res64(&s);
+		job->n = n;
+		job->err = err;
+	}
+	ll_free(&s);
+	return ok;
+}
+
+static void ll_test(LLJob* job, uint32_t node) {
+	uint64_t t0 = sys_now_us();
+	if (job->p <= 64) {
+		job->res64 = (job->p == 2) ? 0 : ll_small(job->p);   // LL needs odd p; M2 = 3 is prime
+		job->n = 0;
+		job->err = 0.0;
+	}
+	else {
+		uint32_t n = ll_length_for(job->p);
+		while (!ll_run(job, n, node)) {
+			fprintf(stderr, "; M%u: rounding past %.2f at n=%u, retrying at %u\n", job->p, LL_MAX_ERR, n, 2 * n);
+			n *= 2;
+		}
+	}
+	job->prime = (job->res64 == 0);
+	job->sec = (double)(sys_now_us() - t0) / 1e6;
+}
+
+// EPOCH_TASK lane: take jobs from the top of the list until none are left.
+static void ll_lane(WorkerCtx* w, void* arg, uint32_t lane) {
+	LLRun* run = (LLRun*)arg;
+	(void)lane;
+	for (;;) {
+		uint32_t i = dec_u32(&run->left);
+		if (i >= run->count) break;   // wrapped below 0
+		LLJob* job = &run->job[i];
+		ll_test(job, w->node);
+		printf("%u, %s, %016llX, %u, %.4f, %.2f\n", job->p, job->prime ? "prime" : "composite",
+			(unsigned long long)job->res64, job->n, job->err, job->sec);
+	}
+}
+
+static int ll_cmp_job(const void* a, const void* b) {
+	uint32_t x = ((const LLJob*)a)->p, y = ((const LLJob*)b)->p;
+	return (x > y) - (x < y);
+}
+
+static int ll_is_known(uint32_t p) {
+	for (uint32_t i = 0; i < LL_KNOWN_COUNT; ++i)
+		if (ll_known[i] == p) return 1;
+	return 0;
+}
+
+// ------------------------------------------------------------
+// Main
+// ------------------------------------------------------------
+
+int main(int argc, char** argv) {
+	setvbuf(stdout, NULL, _IONBF, 0);
+
+	uint32_t p_max = 44497;
+	uint32_t threads = 0;
+	const char* list = NULL;
+
+	for (int a = 1, pos = 0; a < argc; ++a) {
+		const char* arg = argv[a];
+		if (strncmp(arg, "--p=", 4) == 0) { list = arg + 4; continue; }
+		switch (pos++) {
+		case 0: p_max = (uint32_t)strtoul(arg, 0, 10); break;
+		case 1: threads = (uint32_t)strtoul(arg, 0, 10); break;
+		default:
+			fprintf(stderr, "unexpected argument: %s\n", arg);
+			return 1;
+		}
+	}
+
+	LLJob* job = (LLJob*)calloc(LL_MAX_LIST, sizeof(LLJob));
+	if (!job) return 1;
+	uint32_t count = 0;
+	if (list) {
+		for (const char* c = list; *c && count < LL_MAX_LIST;) {
+			char* end;
+			unsigned long p = strtoul(c, &end, 10);
+			if (end == c || p < 2 || p > UINT32_MAX / 2) {
+				fprintf(stderr, "bad exponent list: %s\n", list);
+				return 1;
+			}
+			job[count].p = (uint32_t)p;
+			job[count].known = ll_is_known((uint32_t)p);
+			++count;
+			c = (*end == ',') ? end + 1 : end;
+		}
+	}
+	else {
+		for (uint32_t i = 0; i < LL_KNOWN_COUNT && ll_known[i] <= p_max; ++i) {
+			job[count].p = ll_known[i];
+			job[count].known = 1;
+			++count;
+		}
+	}
+	qsort(job, count, sizeof(LLJob), ll_cmp_job);
+
+	sys_set_priority(PRIORITY_LOW);
+	sys_memory_init();
+
+	JobSystem js;
+	memset(&js, 0, sizeof(js));
+	uint32_t total = count_total_logical();
+	if (threads == 0 || threads > total) threads = total;
+	if (threads > count && count) threads = count;
+	js.thread_count = threads;
+
+	if (!jobq_init(&js.jobs, threads)) return 1;
+	for (uint32_t i = 0; i < EPOCH_DEPTH; ++i)
+		if (!event_init(&js.epoch.slot[i].evt_done)) return 1;
+
+	WorkerCtx* w = (WorkerCtx*)calloc(threads, sizeof(WorkerCtx));
+	SysThread* th = (SysThread*)calloc(threads, sizeof(SysThread));
+	if (!w || !th) return 1;
+	stats_init(&js.stats, threads);
+
+	if (!start_workers(&js, w, th)) {
+		fprintf(stderr, "Failed to start workers\n");
+		return 1;
+	}
+	threads = js.thread_count;
+
+	printf("; Lucas-Lehmer: p, result, res64, n, max_err, seconds\n");
+	uint64_t t0 = sys_now_us();
+	LLRun run = { job, count, 0 };
+	store_u32(&run.left, count);
+	epoch_run_task(&js, ll_lane, &run);
+
+	uint32_t primes = 0, known = 0, failed = 0;
+	for (uint32_t i = 0; i < count; ++i) {
+		primes += job[i].prime;
+		known += job[i].known;
+		if (job[i].known && !job[i].prime) {
+			fprintf(stderr, "; M%u: known Mersenne prime tested composite\n", job[i].p);
+			++failed;
+		}
+	}
+	printf("; %u of %u exponents prime, %u of %u known Mersenne primes verified, %.1f s on %u workers\n",
+		primes, count, known - failed, known, (double)(sys_now_us() - t0) / 1e6, threads);
+
+	stop_workers(&js);
+	wait_all_threads(th, threads);
+	free(th);
+	free(w);
+	for (uint32_t i = 0; i < EPOCH_DEPTH; ++i) event_free(&js.epoch.slot[i].evt_done);
+	jobq_free(&js.jobs);
+	stats_free(&js.stats);
+	free(job);
+	return failed ? 1 : 0;
+}